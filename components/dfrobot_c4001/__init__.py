@@ -1,20 +1,34 @@
+from esphome import automation
+from esphome.automation import maybe_simple_id
 import esphome.codegen as cg
 from esphome.components import uart
 import esphome.config_validation as cv
-from esphome.const import CONF_ID, CONF_MODE, CONF_MODEL
+from esphome.const import CONF_ALPHA, CONF_ID, CONF_MODE, CONF_MODEL, CONF_PLATFORM
+import esphome.final_validate as fv
 
 DEPENDENCIES = ["uart"]
 
 CODEOWNERS = ["@mikelawrence"]
 MULTI_CONF = True
 
+CONF_ARRIVAL_DISTANCE = "arrival_distance"
+CONF_BETA = "beta"
 CONF_DFROBOT_C4001_ID = "dfrobot_c4001_id"
+CONF_RESTORE_CONFIG = "restore_config"
+CONF_SPEED_THRESHOLD = "speed_threshold"
+CONF_TRACKER = "tracker"
 
 dfrobot_c4001_ns = cg.esphome_ns.namespace("dfrobot_c4001")
 DFRobotC4001Hub = dfrobot_c4001_ns.class_(
     "DFRobotC4001Hub", cg.Component, uart.UARTDevice
 )
 
+# Actions
+FactoryResetAction = dfrobot_c4001_ns.class_("FactoryResetAction", automation.Action)
+RestartAction = dfrobot_c4001_ns.class_("RestartAction", automation.Action)
+SetModeAction = dfrobot_c4001_ns.class_("SetModeAction", automation.Action)
+
+DFRobotMode = dfrobot_c4001_ns.enum("DFRobotMode")
 ModeConfig = dfrobot_c4001_ns.enum("ModeConfig")
 ModelConfig = dfrobot_c4001_ns.enum("ModelConfig")
 
@@ -29,6 +43,45 @@ CONF_MODEL_ENUM = {
 }
 
 
+TRACKER_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_ALPHA, default=0.5): cv.float_range(min=0.01, max=1.0),
+        cv.Optional(CONF_BETA, default=0.1): cv.float_range(min=0.0, max=1.0),
+        cv.Optional(CONF_SPEED_THRESHOLD, default=0.2): cv.float_range(
+            min=0.01, max=10.0
+        ),
+        cv.Optional(CONF_ARRIVAL_DISTANCE, default="1m"): cv.All(
+            cv.distance, cv.Range(min=0.0, max=25.0)
+        ),
+    }
+)
+
+
+def mode_select_configured(full_config, hub_id):
+    """True if a mode select can switch the hub between modes at runtime."""
+    for conf in full_config.get("select", []):
+        if (
+            conf.get(CONF_PLATFORM) == "dfrobot_c4001"
+            and str(conf[CONF_DFROBOT_C4001_ID]) == str(hub_id)
+            and CONF_MODE in conf
+        ):
+            return True
+    return False
+
+
+def _final_validate_tracker(config):
+    full_config = fv.full_config.get()
+    if (
+        CONF_TRACKER in config
+        and config[CONF_MODE] != "SPEED_AND_DISTANCE"
+        and not mode_select_configured(full_config, config[CONF_ID])
+    ):
+        raise cv.Invalid(
+            f"'{CONF_TRACKER}' is only available when 'mode' is SPEED_AND_DISTANCE"
+        )
+    return config
+
+
 HUB_CHILD_SCHEMA = cv.Schema(
     {
         cv.GenerateID(CONF_DFROBOT_C4001_ID): cv.use_id(DFRobotC4001Hub),
@@ -41,18 +94,23 @@ CONFIG_SCHEMA = (
             cv.GenerateID(): cv.declare_id(DFRobotC4001Hub),
             cv.Required(CONF_MODE): cv.enum(CONF_MODE_ENUM, upper=True, space="_"),
             cv.Required(CONF_MODEL): cv.enum(CONF_MODEL_ENUM, upper=True, space="_"),
+            cv.Optional(CONF_RESTORE_CONFIG, default=False): cv.boolean,
+            cv.Optional(CONF_TRACKER): TRACKER_SCHEMA,
         }
     )
     .extend(uart.UART_DEVICE_SCHEMA)
     .extend(cv.COMPONENT_SCHEMA)
 )
 
-FINAL_VALIDATE_SCHEMA = uart.final_validate_device_schema(
-    "dfrobot_c4001",
-    require_tx=True,
-    require_rx=True,
-    parity="NONE",
-    stop_bits=1,
+FINAL_VALIDATE_SCHEMA = cv.All(
+    uart.final_validate_device_schema(
+        "dfrobot_c4001",
+        require_tx=True,
+        require_rx=True,
+        parity="NONE",
+        stop_bits=1,
+    ),
+    _final_validate_tracker,
 )
 
 
@@ -63,3 +121,58 @@ async def to_code(config):
 
     cg.add(var.set_mode(config[CONF_MODE]))
     cg.add(var.set_model(config[CONF_MODEL]))
+    if config[CONF_RESTORE_CONFIG]:
+        cg.add(var.set_restore_config(f"dfrobot_c4001.{config[CONF_ID]}"))
+    if tracker := config.get(CONF_TRACKER):
+        cg.add(
+            var.set_tracker(
+                tracker[CONF_ALPHA],
+                tracker[CONF_BETA],
+                tracker[CONF_SPEED_THRESHOLD],
+                tracker[CONF_ARRIVAL_DISTANCE],
+            )
+        )
+
+
+DFROBOT_C4001_ACTION_SCHEMA = maybe_simple_id(
+    {cv.GenerateID(): cv.use_id(DFRobotC4001Hub)}
+)
+
+
+@automation.register_action(
+    "dfrobot_c4001.factory_reset",
+    FactoryResetAction,
+    DFROBOT_C4001_ACTION_SCHEMA,
+    synchronous=False,
+)
+@automation.register_action(
+    "dfrobot_c4001.restart",
+    RestartAction,
+    DFROBOT_C4001_ACTION_SCHEMA,
+    synchronous=False,
+)
+async def dfrobot_c4001_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+
+@automation.register_action(
+    "dfrobot_c4001.set_mode",
+    SetModeAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(DFRobotC4001Hub),
+            cv.Required(CONF_MODE): cv.templatable(
+                cv.enum(CONF_MODE_ENUM, upper=True, space="_")
+            ),
+        }
+    ),
+    synchronous=False,
+)
+async def dfrobot_c4001_set_mode_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    template = await cg.templatable(config[CONF_MODE], args, DFRobotMode)
+    cg.add(var.set_mode(template))
+    return var
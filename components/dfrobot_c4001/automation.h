@@ -0,0 +1,30 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+
+#include "dfrobot_c4001.h"
+
+namespace esphome {
+namespace dfrobot_c4001 {
+
+template<typename... Ts> class FactoryResetAction : public Action<Ts...>, public Parented<DFRobotC4001Hub> {
+ public:
+  void play(const Ts &...x) override { this->parent_->factory_reset(); }
+};
+
+template<typename... Ts> class RestartAction : public Action<Ts...>, public Parented<DFRobotC4001Hub> {
+ public:
+  void play(const Ts &...x) override { this->parent_->restart(); }
+};
+
+template<typename... Ts> class SetModeAction : public Action<Ts...>, public Parented<DFRobotC4001Hub> {
+ public:
+  void play(const Ts &...x) override { this->parent_->switch_mode(this->mode_.value(x...)); }
+
+ protected:
+  TEMPLATABLE_VALUE(DFRobotMode, mode)
+};
+
+}  // namespace dfrobot_c4001
+}  // namespace esphome
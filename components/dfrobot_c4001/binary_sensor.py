@@ -2,18 +2,23 @@ import esphome.codegen as cg
 from esphome.components import binary_sensor
 import esphome.config_validation as cv
 from esphome.const import (
+    CONF_MODE,
+    DEVICE_CLASS_MOTION,
     DEVICE_CLASS_OCCUPANCY,
     DEVICE_CLASS_UPDATE,
     ENTITY_CATEGORY_DIAGNOSTIC,
 )
+import esphome.final_validate as fv
 
-from . import CONF_DFROBOT_C4001_ID, HUB_CHILD_SCHEMA
+from . import CONF_DFROBOT_C4001_ID, HUB_CHILD_SCHEMA, mode_select_configured
 
 DEPENDENCIES = ["dfrobot_c4001"]
 
 
 CONF_OCCUPANCY = "occupancy"
 CONF_CONFIG_CHANGED = "config_changed"
+CONF_TARGET_APPROACHING = "target_approaching"
+CONF_TARGET_LEAVING = "target_leaving"
 
 CONFIG_SCHEMA = (
     cv.Schema(
@@ -25,6 +30,14 @@ CONFIG_SCHEMA = (
                 device_class=DEVICE_CLASS_UPDATE,
                 entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
             ),
+            cv.Optional(CONF_TARGET_APPROACHING): binary_sensor.binary_sensor_schema(
+                device_class=DEVICE_CLASS_MOTION,
+                icon="mdi:arrow-collapse-down",
+            ),
+            cv.Optional(CONF_TARGET_LEAVING): binary_sensor.binary_sensor_schema(
+                device_class=DEVICE_CLASS_MOTION,
+                icon="mdi:arrow-expand-up",
+            ),
         }
     )
     .extend(HUB_CHILD_SCHEMA)
@@ -32,6 +45,25 @@ CONFIG_SCHEMA = (
 )
 
 
+def _final_validate(config):
+    full_config = fv.full_config.get()
+    if mode_select_configured(full_config, config[CONF_DFROBOT_C4001_ID]):
+        # entities of both modes can be used when the mode is switched at runtime
+        return
+    hub_path = full_config.get_path_for_id(config[CONF_DFROBOT_C4001_ID])[:-1]
+    hub_conf = full_config.get_config_for_path(hub_path)
+    MODE = hub_conf.get(CONF_MODE)
+    if MODE == "PRESENCE":
+        for key in (CONF_TARGET_APPROACHING, CONF_TARGET_LEAVING):
+            if key in config:
+                raise cv.Invalid(
+                    f"When 'mode' is set to {MODE}, {key} binary sensor is not allowed."
+                )
+
+
+FINAL_VALIDATE_SCHEMA = _final_validate
+
+
 async def to_code(config):
     sens0609_hub = await cg.get_variable(config[CONF_DFROBOT_C4001_ID])
     if occupancy := config.get(CONF_OCCUPANCY):
@@ -42,3 +74,9 @@ async def to_code(config):
     ):
         bs = await binary_sensor.new_binary_sensor(config_changed)
         cg.add(sens0609_hub.set_config_changed_binary_sensor(bs))
+    if target_approaching := config.get(CONF_TARGET_APPROACHING):
+        bs = await binary_sensor.new_binary_sensor(target_approaching)
+        cg.add(sens0609_hub.set_target_approaching_binary_sensor(bs))
+    if target_leaving := config.get(CONF_TARGET_LEAVING):
+        bs = await binary_sensor.new_binary_sensor(target_leaving)
+        cg.add(sens0609_hub.set_target_leaving_binary_sensor(bs))
@@ -5,6 +5,28 @@ namespace esphome {
 namespace dfrobot_c4001 {
 static const char *const TAG = "dfrobot_c4001.commands";
 
+struct CommandTimeout {
+  const char *command;
+  uint32_t timeout_ms;
+};
+
+// commands that write the module flash or restart it take longer than queries
+static const CommandTimeout COMMAND_TIMEOUTS[] = {
+    {"sensorStart", 1500}, {"sensorStop", 1500}, {"resetSystem", 1500},
+    {"saveConfig", 3000},  {"resetCfg", 3000},   {"setRunApp", 1500},
+};
+static const uint32_t COMMAND_DEFAULT_TIMEOUT = 1000;
+
+// timeout for a command string, looked up by the command name up to the first space
+static uint32_t command_timeout(const char *cmd) {
+  for (const auto &entry : COMMAND_TIMEOUTS) {
+    size_t length = strlen(entry.command);
+    if (strncmp(cmd, entry.command, length) == 0 && (cmd[length] == ' ' || cmd[length] == 0))
+      return entry.timeout_ms;
+  }
+  return COMMAND_DEFAULT_TIMEOUT;
+}
+
 // returns
 //  negative number: failed, abs(return value) is the number of errors that occurred
 //  1: success
@@ -17,32 +39,35 @@ uint8_t Command::execute(DFRobotC4001Hub *parent) {
     this->done_ = false;
     this->error_ = false;
     this->retry_power_stop = false;
-    if (this->parent_->send_cmd_(this->cmd_.c_str(), this->cmd_duration_ms_)) {
+    this->timeout_ms_ = command_timeout(this->cmd_);
+    if (this->parent_->send_cmd_(this->cmd_, this->cmd_duration_ms_)) {
       this->state_ = STATE_WAIT_ECHO;
     }
     return 0;
   }
   // surround state machine with a successful read message
   if (this->parent_->read_message_()) {
-    this->read_buffer_ = this->parent_->read_buffer_;
+    std::string_view line = this->parent_->line_assembler_.line();
+    this->read_buffer_ = this->parent_->line_assembler_.data();
     switch (this->state_) {
       case STATE_WAIT_ECHO:
-        if (this->cmd_ == "resetSystem") {
+        if (strcmp(this->cmd_, "resetSystem") == 0) {
           // resetSystem command might return garbage, accept anything
-          ESP_LOGV(TAG, "Send Cmd: Complete: %s", this->cmd_.c_str());
+          ESP_LOGV(TAG, "Send Cmd: Complete: %s", this->cmd_);
+          this->on_message();
           this->state_ = STATE_DONE;
           return this->error_count_ < 0 ? this->error_count_ : 1;
-        } else if (strstr(this->read_buffer_, this->cmd_.c_str())) {
+        } else if (line.find(this->cmd_) != std::string_view::npos) {
           this->state_ = STATE_PROCESS;
         }
         break;
       case STATE_PROCESS:
-        if (strstr(this->read_buffer_, "Error")) {
+        if (line.find("Error") != std::string_view::npos) {
           this->error_ = true;
           this->state_ = STATE_WAIT_PROMPT;
           break;
         }
-        if (strstr(this->read_buffer_, "sensor is not stopped")) {
+        if (line.find("sensor is not stopped") != std::string_view::npos) {
           // Let queue know we need to stop the sensor and then retry this command
           this->retry_power_stop = true;
           break;
@@ -54,10 +79,12 @@ uint8_t Command::execute(DFRobotC4001Hub *parent) {
         }
         break;
       case STATE_WAIT_PROMPT:
-        if (strstr(this->read_buffer_, "DFRobot:/>")) {
+        // only the prompt ends a line with '>', its text may have been dropped by an overflow
+        if (!line.empty() && line.back() == '>') {
           if (this->error_ || this->retry_power_stop) {
             if (this->retries_left_ > 0) {
               this->retries_left_ -= 1;
+              this->parent_->command_retries_++;
               this->error_count_ -= 1;
               if (this->retry_power_stop) {
                 ESP_LOGD(TAG, "Command Retry: Sensor not stopped");
@@ -76,7 +103,7 @@ uint8_t Command::execute(DFRobotC4001Hub *parent) {
               this->error_count_ -= 1;
             }
           } else {
-            ESP_LOGV(TAG, "Send Cmd: Complete: %s", this->cmd_.c_str());
+            ESP_LOGV(TAG, "Send Cmd: Complete: %s", this->cmd_);
           }
           // Command done
           this->state_ = STATE_DONE;
@@ -90,20 +117,22 @@ uint8_t Command::execute(DFRobotC4001Hub *parent) {
   }
   // check for timeout
   if (millis() - this->parent_->ts_last_cmd_sent_ > this->timeout_ms_) {
-    if (this->cmd_ == "resetSystem") {
+    if (strcmp(this->cmd_, "resetSystem") == 0) {
       // resetSystem command doesn't necessarily return anything, bypass retries
       ESP_LOGV(TAG, "Send Cmd: Reset System Command Timeout Bypassed");
+      this->on_message();
       this->state_ = STATE_DONE;
       // Command done
       return this->error_count_ < 0 ? this->error_count_ : 1;
     } else if (this->retries_left_ > 0) {
       this->retries_left_ -= 1;
+      this->parent_->command_retries_++;
       ESP_LOGD(TAG, "Command timeout: Retrying");
       this->state_ = STATE_CMD_SEND;
       this->error_count_ -= 1;
       return 0;  // command not done
     } else {
-      ESP_LOGE(TAG, "Command Failure: %s", this->cmd_.c_str());
+      ESP_LOGE(TAG, "Command Failure: %s", this->cmd_);
       this->state_ = STATE_DONE;
       this->error_count_ -= 1;
       // Command done
@@ -113,60 +142,18 @@ uint8_t Command::execute(DFRobotC4001Hub *parent) {
   return 0;
 }
 
+ModuleConfig &Command::module_config_() { return this->parent_->module_config_; }
+
 void Command::on_message() {
-  if (strstr(this->parent_->read_buffer_, "Done"))
+  if (this->parent_->line_assembler_.line().find("Done") != std::string_view::npos)
     this->done_ = true;
 }
 
 uint8_t ReadStateCommand::execute(DFRobotC4001Hub *parent) {
-  char *token;
-
   this->parent_ = parent;
+  // reports are decoded and published by the hub while the line is received
   if (this->parent_->read_message_()) {
-    if (strstr(this->parent_->read_buffer_, "$DFHPD,0, , , *")) {
-      this->parent_->set_occupancy(false);
-      ESP_LOGV(TAG, "Recv Rpt: Occupancy Clear");
-      return true;  // Command done
-    } else if (strstr(this->parent_->read_buffer_, "$DFHPD,1, , , *")) {
-      this->parent_->set_occupancy(true);
-      ESP_LOGV(TAG, "Recv Rpt: Occupancy Detected");
-      return true;  // Command done
-    } else if (strstr(this->parent_->read_buffer_, "$DFDMD")) {
-      strtok(this->parent_->read_buffer_, ",");
-      token = strtok(NULL, ",");
-      auto target = parse_number<uint8_t>(token);
-      strtok(NULL, ",");
-      token = strtok(NULL, ",");
-      auto target_distance = parse_number<float>(token);
-      token = strtok(NULL, ",");
-      auto target_speed = parse_number<float>(token);
-      token = strtok(NULL, ",");
-      auto target_energy = parse_number<float>(token);
-      if (target.has_value() && target.value() == 1) {
-        // one target is detected
-        if (target_distance.has_value() && target_speed.has_value() && target_energy.has_value()) {
-          // 1 target is detected, that is all this sensor can do
-          this->parent_->set_target_distance(target_distance.value());
-          this->parent_->set_target_speed(target_speed.value());
-          this->parent_->set_target_energy(target_energy.value());
-          this->parent_->set_occupancy(true);
-          ESP_LOGV(TAG, "Recv Rpt: Target Detected, Dist=%.3f, Speed=%.3f, Energy=%d", target_distance.value(),
-                   target_speed.value(), (uint) target_energy.value());
-          return true;  // command completed successfully
-        } else {
-          ESP_LOGD(TAG, "Error parsing Distance and Speed Detection Output");
-          return true;  // command done with error
-        }
-      } else if (target.has_value() && target == 0) {
-        // no target is detected
-        this->parent_->set_target_distance(0.0);
-        this->parent_->set_target_speed(0.0);
-        this->parent_->set_target_energy(0.0);
-        this->parent_->set_occupancy(false);
-        ESP_LOGV(TAG, "Recv Rpt: No Target");
-        return true;  // command completed successfully
-      }
-    }
+    return true;  // Command done
   }
   if (millis() - this->parent_->ts_last_cmd_sent_ > this->timeout_ms_) {
     return true;  // Command done, timeout
@@ -198,9 +185,20 @@ void GetRangeCommand::on_message() {
 }
 
 SetRangeCommand::SetRangeCommand(float min_range, float max_range) {
-  this->cmd_ = str_sprintf("setRange %.3f %.3f", min_range, max_range);
+  this->min_range_ = min_range;
+  this->max_range_ = max_range;
+  snprintf(this->buffer_, sizeof(this->buffer_), "setRange %.3f %.3f", min_range, max_range);
+  this->cmd_ = this->buffer_;
 };
 
+void SetRangeCommand::on_message() {
+  if (strcmp(this->read_buffer_, "Done") == 0) {
+    this->module_config_().min_range = this->min_range_;
+    this->module_config_().max_range = this->max_range_;
+    this->done_ = true;  // command is done
+  }
+}
+
 GetTrigRangeCommand::GetTrigRangeCommand() { this->cmd_ = "getTrigRange"; }
 
 void GetTrigRangeCommand::on_message() {
@@ -222,9 +220,18 @@ void GetTrigRangeCommand::on_message() {
 }
 
 SetTrigRangeCommand::SetTrigRangeCommand(float trigger_range) {
-  this->cmd_ = str_sprintf("setTrigRange %.3f", trigger_range);
+  this->trigger_range_ = trigger_range;
+  snprintf(this->buffer_, sizeof(this->buffer_), "setTrigRange %.3f", trigger_range);
+  this->cmd_ = this->buffer_;
 };
 
+void SetTrigRangeCommand::on_message() {
+  if (strcmp(this->read_buffer_, "Done") == 0) {
+    this->module_config_().trigger_range = this->trigger_range_;
+    this->done_ = true;  // command is done
+  }
+}
+
 GetSensitivityCommand::GetSensitivityCommand() { this->cmd_ = "getSensitivity"; }
 
 void GetSensitivityCommand::on_message() {
@@ -249,9 +256,21 @@ void GetSensitivityCommand::on_message() {
 }
 
 SetSensitivityCommand::SetSensitivityCommand(float hold_sensitivity, float trigger_sensitivity) {
-  this->cmd_ = str_sprintf("setSensitivity %.0f %.0f", round(hold_sensitivity), round(trigger_sensitivity));
+  this->hold_sensitivity_ = round(hold_sensitivity);
+  this->trigger_sensitivity_ = round(trigger_sensitivity);
+  snprintf(this->buffer_, sizeof(this->buffer_), "setSensitivity %.0f %.0f", this->hold_sensitivity_,
+           this->trigger_sensitivity_);
+  this->cmd_ = this->buffer_;
 };
 
+void SetSensitivityCommand::on_message() {
+  if (strcmp(this->read_buffer_, "Done") == 0) {
+    this->module_config_().hold_sensitivity = this->hold_sensitivity_;
+    this->module_config_().trigger_sensitivity = this->trigger_sensitivity_;
+    this->done_ = true;  // command is done
+  }
+}
+
 GetLatencyCommand::GetLatencyCommand() { this->cmd_ = "getLatency"; }
 
 void GetLatencyCommand::on_message() {
@@ -276,9 +295,20 @@ void GetLatencyCommand::on_message() {
 }
 
 SetLatencyCommand::SetLatencyCommand(float on_latency, float off_latency) {
-  this->cmd_ = str_sprintf("setLatency %.3f %.3f", on_latency, off_latency);
+  this->on_latency_ = on_latency;
+  this->off_latency_ = off_latency;
+  snprintf(this->buffer_, sizeof(this->buffer_), "setLatency %.3f %.3f", on_latency, off_latency);
+  this->cmd_ = this->buffer_;
 };
 
+void SetLatencyCommand::on_message() {
+  if (strcmp(this->read_buffer_, "Done") == 0) {
+    this->module_config_().on_latency = this->on_latency_;
+    this->module_config_().off_latency = this->off_latency_;
+    this->done_ = true;  // command is done
+  }
+}
+
 GetInhibitTimeCommand::GetInhibitTimeCommand() { this->cmd_ = "getInhibit"; }
 
 void GetInhibitTimeCommand::on_message() {
@@ -301,7 +331,18 @@ void GetInhibitTimeCommand::on_message() {
   }
 }
 
-SetInhibitTimeCommand::SetInhibitTimeCommand(float inhibit) { this->cmd_ = str_sprintf("setInhibit %.3f", inhibit); };
+SetInhibitTimeCommand::SetInhibitTimeCommand(float inhibit_time) {
+  this->inhibit_time_ = inhibit_time;
+  snprintf(this->buffer_, sizeof(this->buffer_), "setInhibit %.3f", inhibit_time);
+  this->cmd_ = this->buffer_;
+};
+
+void SetInhibitTimeCommand::on_message() {
+  if (strcmp(this->read_buffer_, "Done") == 0) {
+    this->module_config_().inhibit_time = this->inhibit_time_;
+    this->done_ = true;  // command is done
+  }
+}
 
 GetThrFactorCommand::GetThrFactorCommand() { this->cmd_ = "getThrFactor"; }
 
@@ -324,12 +365,31 @@ void GetThrFactorCommand::on_message() {
 }
 
 SetThrFactorCommand::SetThrFactorCommand(float threshold_factor) {
-  this->cmd_ = str_sprintf("setThrFactor %.3f", threshold_factor);
+  this->threshold_factor_ = threshold_factor;
+  snprintf(this->buffer_, sizeof(this->buffer_), "setThrFactor %.3f", threshold_factor);
+  this->cmd_ = this->buffer_;
 };
 
-SetLedModeCommand::SetLedModeCommand(bool value) { this->cmd_ = str_sprintf("setLedMode 1 %d", value ? 0 : 1); };
+void SetThrFactorCommand::on_message() {
+  if (strcmp(this->read_buffer_, "Done") == 0) {
+    this->module_config_().threshold_factor = this->threshold_factor_;
+    this->done_ = true;  // command is done
+  }
+}
+
+SetLedModeCommand::SetLedModeCommand(bool value) { this->cmd_ = value ? "setLedMode 1 0" : "setLedMode 1 1"; };
+
+SetGpioModeCommand::SetGpioModeCommand(bool value) {
+  this->out_led_enable_ = value;
+  this->cmd_ = value ? "setGpioMode 1 1" : "setGpioMode 1 2";
+};
 
-SetGpioModeCommand::SetGpioModeCommand(bool value) { this->cmd_ = str_sprintf("setGpioMode 1 %d", value ? 1 : 2); };
+void SetGpioModeCommand::on_message() {
+  if (strcmp(this->read_buffer_, "Done") == 0) {
+    this->module_config_().out_led_enable = this->out_led_enable_;
+    this->done_ = true;  // command is done
+  }
+}
 
 GetGpioModeCommand::GetGpioModeCommand() { this->cmd_ = "getGpioMode 1"; }
 
@@ -379,7 +439,8 @@ SetMicroMotionCommand::SetMicroMotionCommand(bool enable) {
 
 void SetMicroMotionCommand::on_message() {
   if (strcmp(this->read_buffer_, "Done") == 0) {
-    this->parent_->set_micro_motion_enable(this->micro_motion_, false);
+    // the switch keeps its state, it may have been changed again while this command was queued
+    this->module_config_().micro_motion_enable = this->micro_motion_;
     this->done_ = true;  // command is done
   }
 }
@@ -407,7 +468,7 @@ void ResetSystemCommand::on_message() {
   if (this->read_config_) {
     this->parent_->config_load();
   }
-  ESP_LOGV(TAG, "Send Cmd: %s received something", this->cmd_.c_str());
+  ESP_LOGV(TAG, "Send Cmd: %s received something", this->cmd_);
   this->done_ = true;  // command is done
 }
 
@@ -417,7 +478,7 @@ void SaveCfgCommand::on_message() {
   if (strstr(this->read_buffer_, "no parameter has changed")) {
     ESP_LOGV(TAG, "Send Cmd: Nothing Changed");
   } else if (strstr(this->read_buffer_, "Done")) {
-    this->parent_->config_load();
+    // module_config_ already holds what the set commands wrote, nothing needs to be read back
     this->done_ = true;  // command is done
   }
 }
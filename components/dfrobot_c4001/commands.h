@@ -6,6 +6,11 @@
 namespace esphome {
 namespace dfrobot_c4001 {
 class DFRobotC4001Hub;
+struct ModuleConfig;
+
+// longest formatted command is "setLatency 100.000 1500.000"
+static const uint8_t COMMAND_MAX_LENGTH = 32;
+
 // Enumeration for Command States
 enum CommandState {
   STATE_CMD_SEND = 0,  // command needs to be sent
@@ -16,8 +21,8 @@ enum CommandState {
 };
 
 // Use command queue and time stamps to avoid blocking.
-// When component has run time, check if minimum time (1s) between
-// commands has passed. After that run a command from the queue.
+// A command is sent as soon as the previous one was terminated by the prompt,
+// without a prompt the minimum time between commands has to pass first.
 class Command {
  public:
   virtual ~Command() = default;
@@ -30,12 +35,21 @@ class Command {
   uint8_t state_{STATE_CMD_SEND};
   uint8_t done_{false};
   uint8_t error_{false};
-  std::string cmd_;
+  const char *cmd_{""};  // string literal or the buffer of a FormattedCommand
   char *read_buffer_{nullptr};
   int8_t error_count_{0};
   int8_t retries_left_{2};
   uint32_t cmd_duration_ms_{10};
-  uint32_t timeout_ms_{1500};
+  uint32_t timeout_ms_{1500};  // set from the command timeout table when sent
+
+  // what the module holds, set commands update it when the module confirms the write
+  ModuleConfig &module_config_();
+};
+
+// command with arguments, the command string is formatted into the object itself
+class FormattedCommand : public Command {
+ protected:
+  char buffer_[COMMAND_MAX_LENGTH];
 };
 
 class ReadStateCommand : public Command {
@@ -58,9 +72,14 @@ class GetRangeCommand : public Command {
   optional<float> max_range_;
 };
 
-class SetRangeCommand : public Command {
+class SetRangeCommand : public FormattedCommand {
  public:
   SetRangeCommand(float min_range, float max_range);
+  void on_message() override;
+
+ protected:
+  float min_range_;
+  float max_range_;
 };
 
 class GetTrigRangeCommand : public Command {
@@ -72,9 +91,13 @@ class GetTrigRangeCommand : public Command {
   optional<float> trigger_range_;
 };
 
-class SetTrigRangeCommand : public Command {
+class SetTrigRangeCommand : public FormattedCommand {
  public:
   SetTrigRangeCommand(float trigger_range);
+  void on_message() override;
+
+ protected:
+  float trigger_range_;
 };
 
 class GetSensitivityCommand : public Command {
@@ -87,9 +110,14 @@ class GetSensitivityCommand : public Command {
   optional<float> trigger_sensitivity_;
 };
 
-class SetSensitivityCommand : public Command {
+class SetSensitivityCommand : public FormattedCommand {
  public:
   SetSensitivityCommand(float hold_sensitivity, float trigger_sensitivity);
+  void on_message() override;
+
+ protected:
+  float hold_sensitivity_;
+  float trigger_sensitivity_;
 };
 
 class GetLatencyCommand : public Command {
@@ -102,9 +130,14 @@ class GetLatencyCommand : public Command {
   optional<float> off_latency_;
 };
 
-class SetLatencyCommand : public Command {
+class SetLatencyCommand : public FormattedCommand {
  public:
   SetLatencyCommand(float on_latency, float off_latency);
+  void on_message() override;
+
+ protected:
+  float on_latency_;
+  float off_latency_;
 };
 
 class GetInhibitTimeCommand : public Command {
@@ -116,9 +149,13 @@ class GetInhibitTimeCommand : public Command {
   optional<float> inhibit_time_;
 };
 
-class SetInhibitTimeCommand : public Command {
+class SetInhibitTimeCommand : public FormattedCommand {
  public:
   SetInhibitTimeCommand(float inhibit_time);
+  void on_message() override;
+
+ protected:
+  float inhibit_time_;
 };
 
 class GetThrFactorCommand : public Command {
@@ -130,9 +167,13 @@ class GetThrFactorCommand : public Command {
   optional<float> threshold_factor_;
 };
 
-class SetThrFactorCommand : public Command {
+class SetThrFactorCommand : public FormattedCommand {
  public:
   SetThrFactorCommand(float threshold_factor);
+  void on_message() override;
+
+ protected:
+  float threshold_factor_;
 };
 
 class SetUartOutputCommand : public Command {
@@ -148,6 +189,10 @@ class SetLedModeCommand : public Command {
 class SetGpioModeCommand : public Command {
  public:
   SetGpioModeCommand(bool value);
+  void on_message() override;
+
+ protected:
+  bool out_led_enable_;
 };
 
 class GetGpioModeCommand : public Command {
@@ -1,6 +1,8 @@
 #include "dfrobot_c4001.h"
 
 #include <cmath>
+#include <cstddef>
+#include <cstring>
 
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
@@ -11,6 +13,7 @@ namespace dfrobot_c4001 {
 static const char *const TAG = "dfrobot_c4001";
 const char ASCII_CR = 0x0D;
 const char ASCII_LF = 0x0A;
+static const float CONFIG_FLOAT_TOLERANCE = 0.001f;  // module reports parameters with 3 decimals
 
 static inline const char *mode_to_str(DFRobotMode mode) {
   switch (mode) {
@@ -35,7 +38,11 @@ static inline const char *model_to_str(DFRobotModel model) {
 }
 
 void DFRobotC4001Hub::set_occupancy(bool occupancy) {
+  // every report line repeats the occupancy, only publish changes
+  if (this->occupancy_published_ && occupancy == this->occupancy_)
+    return;
   this->occupancy_ = occupancy;
+  this->occupancy_published_ = true;
 #ifdef USE_BINARY_SENSOR
   if (this->occupancy_binary_sensor_ != nullptr) {
     this->occupancy_binary_sensor_->publish_state(occupancy);
@@ -46,27 +53,21 @@ void DFRobotC4001Hub::set_occupancy(bool occupancy) {
 void DFRobotC4001Hub::set_target_distance(float value) {
   this->target_distance_ = value;
 #ifdef USE_SENSOR
-  if (this->target_distance_sensor_ != nullptr) {
-    this->target_distance_sensor_->publish_state(value);
-  }
+  this->target_distance_sensor_.publish_state(value);
 #endif
 }
 
 void DFRobotC4001Hub::set_target_speed(float value) {
   this->target_speed_ = value;
 #ifdef USE_SENSOR
-  if (this->target_speed_sensor_ != nullptr) {
-    this->target_speed_sensor_->publish_state(value);
-  }
+  this->target_speed_sensor_.publish_state(value);
 #endif
 }
 
 void DFRobotC4001Hub::set_target_energy(float value) {
   this->target_energy_ = value;
 #ifdef USE_SENSOR
-  if (this->target_energy_sensor_ != nullptr) {
-    this->target_energy_sensor_->publish_state(value);
-  }
+  this->target_energy_sensor_.publish_state(value);
 #endif
 }
 
@@ -91,6 +92,8 @@ void DFRobotC4001Hub::set_max_range(float max, bool needs_save) {
   this->max_range_ = max;
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.max_range = max;
   }
 }
 
@@ -115,6 +118,8 @@ void DFRobotC4001Hub::set_min_range(float min, bool needs_save) {
   this->min_range_ = min;
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.min_range = min;
   }
 }
 
@@ -139,6 +144,8 @@ void DFRobotC4001Hub::set_trigger_range(float trig, bool needs_save) {
   this->trigger_range_ = trig;
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.trigger_range = trig;
   }
 }
 
@@ -151,6 +158,8 @@ void DFRobotC4001Hub::set_hold_sensitivity(float value, bool needs_save) {
 #endif
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.hold_sensitivity = value;
   }
 }
 
@@ -163,6 +172,8 @@ void DFRobotC4001Hub::set_trigger_sensitivity(float value, bool needs_save) {
 #endif
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.trigger_sensitivity = value;
   }
 }
 
@@ -175,6 +186,8 @@ void DFRobotC4001Hub::set_on_latency(float value, bool needs_save) {
 #endif
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.on_latency = value;
   }
 }
 
@@ -187,6 +200,8 @@ void DFRobotC4001Hub::set_off_latency(float value, bool needs_save) {
 #endif
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.off_latency = value;
   }
 }
 
@@ -199,6 +214,8 @@ void DFRobotC4001Hub::set_inhibit_time(float value, bool needs_save) {
 #endif
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.inhibit_time = value;
   }
 }
 
@@ -211,6 +228,8 @@ void DFRobotC4001Hub::set_threshold_factor(float value, bool needs_save) {
 #endif
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.threshold_factor = value;
   }
 }
 
@@ -223,6 +242,8 @@ void DFRobotC4001Hub::set_out_led_enable(bool value, bool needs_save) {
 #endif
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.out_led_enable = value;
   }
 }
 
@@ -247,6 +268,8 @@ void DFRobotC4001Hub::set_micro_motion_enable(bool enable, bool needs_save) {
 #endif
   if (needs_save) {
     this->set_needs_save(true);
+  } else {
+    this->module_config_.micro_motion_enable = enable;
   }
 }
 
@@ -261,6 +284,15 @@ void DFRobotC4001Hub::set_software_version(char *version) {
 }
 
 void DFRobotC4001Hub::set_hardware_version(char *version) {
+  if (this->verify_config_) {
+    this->verify_config_ = false;
+    if (this->hw_version_ != version) {
+      ESP_LOGD(TAG, "Hardware version changed, reading config from module");
+      this->config_load();
+    } else {
+      ESP_LOGD(TAG, "Restored config verified");
+    }
+  }
   std::string new_string(version);
   if (str_startswith(new_string, "JYSJ_428")) {
     this->hw_model_ = MODEL_SEN0609;
@@ -289,6 +321,59 @@ void DFRobotC4001Hub::flash_run_led_enable() {
 
 void DFRobotC4001Hub::set_mode(DFRobotMode value) { this->mode_ = value; }
 
+// switches the run app without a reboot, entities of the other mode keep their last values
+void DFRobotC4001Hub::switch_mode(DFRobotMode mode) {
+  if (mode >= MODE_UNKNOWN)
+    return;
+  if (mode != this->mode_) {
+    ESP_LOGD(TAG, "Switching to %s mode", mode_to_str(mode));
+    // unsaved changes belong to the current mode, they are saved within the same stop and start
+    ConfigChanges changes;
+    if (this->needs_save_) {
+      this->set_needs_save(false);
+      changes = this->get_config_changes_();
+    }
+    this->enqueue<PowerCommand>(false);
+    if (changes.any())
+      this->enqueue_config_changes_(changes);
+    this->enqueue<SetRunAppCommand>(mode);
+    if (mode == MODE_PRESENCE) {
+      this->enqueue<SetUartOutputCommand>(true);
+    }
+    this->enqueue<PowerCommand>(true);
+
+    this->mode_ = mode;
+    // the LED states are shared by both modes, the parameters of the new mode are read from the module
+    ModuleConfig config;
+    config.out_led_enable = this->module_config_.out_led_enable;
+    config.run_led_enable = this->module_config_.run_led_enable;
+    this->module_config_ = config;
+    this->load_mode_config_();
+
+    // targets are only reported in SPEED_AND_DISTANCE mode
+    this->tracker_.reset();
+    this->publish_tracker_();
+    if (mode == MODE_PRESENCE) {
+      this->set_target_distance(NAN);
+      this->set_target_speed(NAN);
+      this->set_target_energy(NAN);
+    }
+  }
+#ifdef USE_SELECT
+  if (this->mode_select_ != nullptr) {
+    this->mode_select_->publish_state(this->mode_);
+  }
+#endif
+}
+
+// parameters of the other mode are not accepted by the module, returns false and warns if mode is not active
+bool DFRobotC4001Hub::check_mode(DFRobotMode mode, const char *name) {
+  if (this->mode_ == mode)
+    return true;
+  ESP_LOGW(TAG, "%s can only be changed in %s mode", name, mode_to_str(mode));
+  return false;
+}
+
 void DFRobotC4001Hub::set_model(DFRobotModel value) { this->model_ = value; }
 
 void DFRobotC4001Hub::set_needs_save(bool needs_save) {
@@ -316,105 +401,253 @@ void DFRobotC4001Hub::setup_module() {
   }
 #endif
   // stop the module so that configuration can be set
-  this->enqueue(make_unique<PowerCommand>(false));
+  this->enqueue<PowerCommand>(false);
   // put the module is the requested mode
-  this->enqueue(make_unique<SetRunAppCommand>(this->mode_));
+  this->enqueue<SetRunAppCommand>(this->mode_);
   // the module doesn't remember the RUN led state so it need to be set here
   // this->run_led_enable_ comes from flash which does remember between power cycles
-  this->enqueue(make_unique<SetLedModeCommand>(this->run_led_enable_));
+  this->enqueue<SetLedModeCommand>(this->run_led_enable_);
+  this->module_config_.run_led_enable = this->run_led_enable_;
   // the module remembers the OUT led state so it does not need to be set here
   // make sure the module output presence via uart
   if (this->mode_ == MODE_PRESENCE) {
-    this->enqueue(make_unique<SetUartOutputCommand>(true));
+    this->enqueue<SetUartOutputCommand>(true);
   }
   // start the module
-  this->enqueue(make_unique<PowerCommand>(true));
+  this->enqueue<PowerCommand>(true);
 }
 
 void DFRobotC4001Hub::config_load() {
   // get dfrobot_c4001 current configuration
   // have to be in the right mode to read that mode's parameters
-  this->enqueue(make_unique<GetHWVCommand>());
-  this->enqueue(make_unique<GetSWVCommand>());
+  this->enqueue<GetHWVCommand>();
+  this->enqueue<GetSWVCommand>();
   // the module doesn't remember the RUN led state (controlled by LedMode command) so loading from module won't work
   // the OUT led state is controlled by GpioMode command and it is remembered by the module so loading does work
-  this->enqueue(make_unique<GetGpioModeCommand>());
+  this->enqueue<GetGpioModeCommand>();
+  this->load_mode_config_();
+  this->set_needs_save(false);
+}
+
+// reads the parameters of the current mode
+void DFRobotC4001Hub::load_mode_config_() {
 #ifdef USE_NUMBER
   if (this->min_range_number_ != nullptr)
-    this->enqueue(make_unique<GetRangeCommand>());
+    this->enqueue<GetRangeCommand>();
 #endif
   if (this->mode_ == MODE_PRESENCE) {
 #ifdef USE_NUMBER
     if (this->trigger_range_number_ != nullptr)
-      this->enqueue(make_unique<GetTrigRangeCommand>());
+      this->enqueue<GetTrigRangeCommand>();
     if (this->hold_sensitivity_number_ != nullptr)
-      this->enqueue(make_unique<GetSensitivityCommand>());
+      this->enqueue<GetSensitivityCommand>();
     if (this->on_latency_number_ != nullptr)
-      this->enqueue(make_unique<GetLatencyCommand>());
+      this->enqueue<GetLatencyCommand>();
     if (this->inhibit_time_number_ != nullptr)
-      this->enqueue(make_unique<GetInhibitTimeCommand>());
+      this->enqueue<GetInhibitTimeCommand>();
 #endif
   } else {
 #ifdef USE_NUMBER
     if (this->threshold_factor_number_ != nullptr)
-      this->enqueue(make_unique<GetThrFactorCommand>());
+      this->enqueue<GetThrFactorCommand>();
 #endif
 #ifdef USE_SWITCH
     if (this->micro_motion_enable_switch_ != nullptr)
-      this->enqueue(make_unique<GetMicroMotionCommand>());
+      this->enqueue<GetMicroMotionCommand>();
 #endif
   }
-  this->set_needs_save(false);
 }
 
-void DFRobotC4001Hub::config_save() {
-  if (this->needs_save_) {
-    this->flash_run_led_enable();
-    this->enqueue(make_unique<PowerCommand>(false));
-    this->enqueue(make_unique<SetLedModeCommand>(this->run_led_enable_));
-    this->enqueue(make_unique<SetGpioModeCommand>(this->out_led_enable_));
+static bool float_changed(float module_value, float value) {
+  return std::isnan(module_value) || std::fabs(module_value - value) > CONFIG_FLOAT_TOLERANCE;
+}
+
+// compares the requested parameters of the current mode with the module_config_
+ConfigChanges DFRobotC4001Hub::get_config_changes_() {
+  const ModuleConfig &module = this->module_config_;
+  ConfigChanges changes;
+  changes.run_led = module.run_led_enable != this->run_led_enable_;
+  changes.out_led = module.out_led_enable != this->out_led_enable_;
 #ifdef USE_NUMBER
-    if (this->min_range_number_ != nullptr)
-      this->enqueue(make_unique<SetRangeCommand>(this->min_range_, this->max_range_));
+  changes.range = this->min_range_number_ != nullptr && (float_changed(module.min_range, this->min_range_) ||
+                                                         float_changed(module.max_range, this->max_range_));
 #endif
-    if (this->mode_ == MODE_PRESENCE) {
+  if (this->mode_ == MODE_PRESENCE) {
 #ifdef USE_NUMBER
-      if (this->trigger_range_number_ != nullptr)
-        this->enqueue(make_unique<SetTrigRangeCommand>(this->trigger_range_));
-      if (this->hold_sensitivity_number_ != nullptr)
-        this->enqueue(make_unique<SetSensitivityCommand>(this->hold_sensitivity_, this->trigger_sensitivity_));
-      if (this->on_latency_number_ != nullptr)
-        this->enqueue(make_unique<SetLatencyCommand>(this->on_latency_, this->off_latency_));
-      if (this->inhibit_time_number_ != nullptr)
-        this->enqueue(make_unique<SetInhibitTimeCommand>(this->inhibit_time_));
+    changes.trigger_range =
+        this->trigger_range_number_ != nullptr && float_changed(module.trigger_range, this->trigger_range_);
+    changes.sensitivity = this->hold_sensitivity_number_ != nullptr &&
+                          (float_changed(module.hold_sensitivity, this->hold_sensitivity_) ||
+                           float_changed(module.trigger_sensitivity, this->trigger_sensitivity_));
+    changes.latency = this->on_latency_number_ != nullptr && (float_changed(module.on_latency, this->on_latency_) ||
+                                                              float_changed(module.off_latency, this->off_latency_));
+    changes.inhibit_time =
+        this->inhibit_time_number_ != nullptr && float_changed(module.inhibit_time, this->inhibit_time_);
 #endif
-    } else {
+  } else {
 #ifdef USE_NUMBER
-      if (this->threshold_factor_number_ != nullptr)
-        this->enqueue(make_unique<SetThrFactorCommand>(this->threshold_factor_));
+    changes.threshold_factor =
+        this->threshold_factor_number_ != nullptr && float_changed(module.threshold_factor, this->threshold_factor_);
 #endif
 #ifdef USE_SWITCH
-      if (this->micro_motion_enable_switch_ != nullptr)
-        this->enqueue(make_unique<SetMicroMotionCommand>(this->micro_motion_enable_));
+    changes.micro_motion = this->micro_motion_enable_switch_ != nullptr &&
+                           module.micro_motion_enable != this->micro_motion_enable_;
 #endif
-    }
-    this->enqueue(make_unique<SaveCfgCommand>());
-    this->enqueue(make_unique<ResetSystemCommand>(true));
-    this->enqueue(make_unique<PowerCommand>(true));
-    this->set_needs_save(false);
   }
+  return changes;
+}
+
+// queues the set commands and saveConfig, the sensor has to be stopped first
+// module_config_ is updated by each set command when the module confirms it
+void DFRobotC4001Hub::enqueue_config_changes_(const ConfigChanges &changes) {
+  this->ts_config_save_ = millis();
+  this->config_save_pending_ = true;
+  if (changes.run_led) {
+    this->flash_run_led_enable();
+    this->enqueue<SetLedModeCommand>(this->run_led_enable_);
+    this->module_config_.run_led_enable = this->run_led_enable_;
+  }
+  if (changes.out_led)
+    this->enqueue<SetGpioModeCommand>(this->out_led_enable_);
+  if (changes.range)
+    this->enqueue<SetRangeCommand>(this->min_range_, this->max_range_);
+  if (changes.trigger_range)
+    this->enqueue<SetTrigRangeCommand>(this->trigger_range_);
+  if (changes.sensitivity)
+    this->enqueue<SetSensitivityCommand>(this->hold_sensitivity_, this->trigger_sensitivity_);
+  if (changes.latency)
+    this->enqueue<SetLatencyCommand>(this->on_latency_, this->off_latency_);
+  if (changes.inhibit_time)
+    this->enqueue<SetInhibitTimeCommand>(this->inhibit_time_);
+  if (changes.threshold_factor)
+    this->enqueue<SetThrFactorCommand>(this->threshold_factor_);
+  if (changes.micro_motion)
+    this->enqueue<SetMicroMotionCommand>(this->micro_motion_enable_);
+  if (changes.needs_module_save())
+    this->enqueue<SaveCfgCommand>();
+}
+
+// changes made while the save is queued set needs_save again and are sent by the next save
+void DFRobotC4001Hub::config_save() {
+  if (!this->needs_save_)
+    return;
+  this->set_needs_save(false);
+
+  ConfigChanges changes = this->get_config_changes_();
+  if (!changes.any()) {
+    ESP_LOGD(TAG, "Config unchanged, nothing to save");
+    return;
+  }
+  this->enqueue<PowerCommand>(false);
+  this->enqueue_config_changes_(changes);
+  if (changes.needs_module_save())
+    this->enqueue<ResetSystemCommand>(false);
+  this->enqueue<PowerCommand>(true);
 }
 
 void DFRobotC4001Hub::factory_reset() {
   ESP_LOGD(TAG, "Factory Reset Started");
-  this->enqueue(make_unique<PowerCommand>(false));
-  this->enqueue(make_unique<FactoryResetCommand>());
+  this->enqueue<PowerCommand>(false);
+  this->enqueue<FactoryResetCommand>();
 }
 
 void DFRobotC4001Hub::restart() {
   ESP_LOGD(TAG, "Restart Started");
-  this->enqueue(make_unique<PowerCommand>(false));
-  this->enqueue(make_unique<ResetSystemCommand>(true));
+  this->enqueue<PowerCommand>(false);
+  this->enqueue<ResetSystemCommand>(true);
+}
+
+ConfigCache DFRobotC4001Hub::get_config_cache_() {
+  ConfigCache cache;
+  memset(static_cast<void *>(&cache), 0, sizeof(cache));  // padding is part of the hash
+  strncpy(cache.hw_version, this->hw_version_.c_str(), VERSION_LENGTH - 1);
+  strncpy(cache.sw_version, this->sw_version_.c_str(), VERSION_LENGTH - 1);
+  cache.config = this->module_config_;
+  cache.mode = this->mode_;
+
+  // FNV-1a over everything but the hash itself
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&cache);
+  uint32_t hash = 2166136261UL;
+  for (size_t i = 0; i < offsetof(ConfigCache, hash); i++) {
+    hash = (hash ^ bytes[i]) * 16777619UL;
+  }
+  cache.hash = hash;
+  return cache;
+}
+
+// publishes the stored config, returns false if there is none for the configured mode
+bool DFRobotC4001Hub::restore_config_cache_() {
+  this->config_pref_ = global_preferences->make_preference<ConfigCache>(this->config_key_);
+  ConfigCache cache;
+  if (!this->config_pref_.load(&cache)) {
+    ESP_LOGD(TAG, "No stored config, reading from module");
+    return false;
+  }
+  if (cache.mode != this->mode_) {
+    ESP_LOGD(TAG, "Stored config is for another mode, reading from module");
+    return false;
+  }
+  if (cache.hw_version[0] == 0) {
+    ESP_LOGD(TAG, "Stored config has no hardware version, reading from module");
+    return false;
+  }
+  cache.hw_version[VERSION_LENGTH - 1] = 0;
+  cache.sw_version[VERSION_LENGTH - 1] = 0;
+  this->hw_version_ = cache.hw_version;
+  this->sw_version_ = cache.sw_version;
+  this->module_config_ = cache.config;
+  if (this->get_config_cache_().hash != cache.hash) {
+    ESP_LOGW(TAG, "Stored config is corrupted, reading from module");
+    this->hw_version_.clear();
+    this->sw_version_.clear();
+    this->module_config_ = ModuleConfig();
+    return false;
+  }
+  this->config_saved_hash_ = cache.hash;
+
+  ESP_LOGD(TAG, "Restored config for %s, verifying", cache.hw_version);
+  this->set_hardware_version(cache.hw_version);
+  this->set_software_version(cache.sw_version);
+  const ModuleConfig &config = cache.config;
+  if (!std::isnan(config.min_range) && !std::isnan(config.max_range)) {
+    this->set_min_range(config.min_range, false);
+    this->set_max_range(config.max_range, false);
+  }
+  if (!std::isnan(config.trigger_range))
+    this->set_trigger_range(config.trigger_range, false);
+  if (!std::isnan(config.hold_sensitivity) && !std::isnan(config.trigger_sensitivity)) {
+    this->set_hold_sensitivity(config.hold_sensitivity, false);
+    this->set_trigger_sensitivity(config.trigger_sensitivity, false);
+  }
+  if (!std::isnan(config.on_latency) && !std::isnan(config.off_latency)) {
+    this->set_on_latency(config.on_latency, false);
+    this->set_off_latency(config.off_latency, false);
+  }
+  if (!std::isnan(config.inhibit_time))
+    this->set_inhibit_time(config.inhibit_time, false);
+  if (!std::isnan(config.threshold_factor))
+    this->set_threshold_factor(config.threshold_factor, false);
+  if (config.out_led_enable != 0xFF)
+    this->set_out_led_enable(config.out_led_enable, false);
+  if (config.micro_motion_enable != 0xFF)
+    this->set_micro_motion_enable(config.micro_motion_enable, false);
+  this->set_needs_save(false);
+  return true;
+}
+
+// called whenever the command queue drains, flash is written only when the config changed
+void DFRobotC4001Hub::save_config_cache_() {
+  if (!this->restore_config_ || this->hw_version_.empty())
+    return;
+  ConfigCache cache = this->get_config_cache_();
+  if (cache.hash == this->config_saved_hash_)
+    return;
+  if (this->config_pref_.save(&cache)) {
+    this->config_saved_hash_ = cache.hash;
+    ESP_LOGD(TAG, "Config stored");
+  } else {
+    ESP_LOGW(TAG, "Storing config failed");
+  }
 }
 
 void DFRobotC4001Hub::dump_config() {
@@ -426,6 +659,10 @@ void DFRobotC4001Hub::dump_config() {
                 "  Mode: %s\n",
                 this->sw_version_.c_str(), this->hw_version_.c_str(), model_to_str(this->model_),
                 mode_to_str(this->mode_));
+  ESP_LOGCONFIG(TAG, "  Restore config: %s", YESNO(this->restore_config_));
+  if (this->mode_ == MODE_SPEED_AND_DISTANCE) {
+    ESP_LOGCONFIG(TAG, "  Tracker arrival distance: %.2f m", this->tracker_.get_arrival_distance());
+  }
   bool models_good = this->model_ == this->hw_model_;
   if (this->hw_model_ == MODEL_UNKNOWN) {
     models_good = true;
@@ -439,10 +676,29 @@ void DFRobotC4001Hub::dump_config() {
   LOG_BUTTON("  ", "Restart", this->restart_button_);
   LOG_BUTTON("  ", "Factory Reset", this->factory_reset_button_);
 #endif
+#ifdef USE_SELECT
+  ESP_LOGCONFIG(TAG, "Selects:");
+  LOG_SELECT("  ", "Mode", this->mode_select_);
+#endif
 #ifdef USE_BINARY_SENSOR
   ESP_LOGCONFIG(TAG, "Binary Sensors:");
   LOG_BINARY_SENSOR("  ", "Occupancy", this->occupancy_binary_sensor_);
   LOG_BINARY_SENSOR("  ", "Config Changed", this->config_changed_binary_sensor_);
+  LOG_BINARY_SENSOR("  ", "Target Approaching", this->target_approaching_binary_sensor_);
+  LOG_BINARY_SENSOR("  ", "Target Leaving", this->target_leaving_binary_sensor_);
+#endif
+#ifdef USE_SENSOR
+  ESP_LOGCONFIG(TAG, "Sensors:");
+  LOG_SENSOR("  ", "Startup Time", this->startup_time_sensor_);
+  LOG_SENSOR("  ", "Config Save Time", this->config_save_time_sensor_);
+  LOG_SENSOR("  ", "Command Retries", this->command_retries_sensor_);
+  LOG_SENSOR("  ", "Target Distance", this->target_distance_sensor_.get_sensor());
+  LOG_SENSOR("  ", "Target Speed", this->target_speed_sensor_.get_sensor());
+  LOG_SENSOR("  ", "Target Energy", this->target_energy_sensor_.get_sensor());
+  for (const auto &entry : this->time_to_arrival_sensors_) {
+    LOG_SENSOR("  ", "Time To Arrival", entry.sensor.get_sensor());
+    ESP_LOGCONFIG(TAG, "    Arrival distance: %.2f m", this->get_arrival_distance_(entry.arrival_distance));
+  }
 #endif
 #ifdef USE_NUMBER
   ESP_LOGCONFIG(TAG, "Numbers:");
@@ -484,34 +740,58 @@ void DFRobotC4001Hub::setup() {
     }
     this->set_run_led_enable(value, false);
   }
+#endif
+#ifdef USE_SELECT
+  if (this->mode_select_ != nullptr) {
+    this->mode_select_->publish_state(this->mode_);
+  }
 #endif
   // setup the module
-  this->enqueue(make_unique<ResetSystemCommand>(false));
+  this->ts_setup_ = millis();
+  this->enqueue<ResetSystemCommand>(false);
   this->setup_module();
-  this->config_load();
+  if (this->restore_config_ && this->restore_config_cache_()) {
+    // the hardware version read confirms the restored config, everything else is only read on mismatch
+    this->verify_config_ = true;
+    this->enqueue<GetHWVCommand>();
+  } else {
+    this->config_load();
+  }
 }
 
 void DFRobotC4001Hub::loop() {
   if (this->is_failed()) {
     return;
   }
+  // keep going while commands complete or lines are waiting, the next command is sent as soon as the prompt is seen
+  for (uint8_t step = 0; step < MAX_STEPS_PER_LOOP; step++) {
+    if (!this->process_step_())
+      break;
+  }
+}
+
+// runs the command in front of the queue once, returns true if another step can make progress right away
+bool DFRobotC4001Hub::process_step_() {
+  uint32_t lines_received = this->lines_received_;
   if (this->cmd_queue_.is_empty()) {
     // Command queue empty, first time this happens setup is complete
     if (!this->is_setup_) {
       this->is_setup_ = true;
       if (this->ts_cmd_error_cnt_ > 3) {
         this->mark_failed(LOG_STR("Too many errors"));
+        return false;
       }
     }
     // Read sensor state
-    this->enqueue(make_unique<ReadStateCommand>());
+    this->read_state_cmd_.execute(this);
+    return this->lines_received_ != lines_received && this->available() > 0;
   }
   // Commands are non-blocking and need to be called repeatedly.
   int8_t result = this->cmd_queue_.process(this);
   if (result) {
     if (this->cmd_queue_.is_retry_power_stop()) {
       // add PowerCommand to the beginning of the queue to stop the sensor
-      this->enqueue(make_unique<PowerCommand>(false), true);
+      this->cmd_queue_.enqueue<PowerCommand>(LANE_CONTROL, true, false);
       ESP_LOGV(TAG, "Queue: Retrying command after stopping sensor");
     } else {
       // negative result means errors occurred magnitude is number of errors
@@ -521,58 +801,154 @@ void DFRobotC4001Hub::loop() {
       }
       // dequeue the command
       this->cmd_queue_.dequeue();
+      if (this->cmd_queue_.is_empty()) {
+        if (this->verify_config_) {
+          // the hardware version read failed, the restored config can't be trusted
+          this->verify_config_ = false;
+          ESP_LOGW(TAG, "Restored config not verified, reading config from module");
+          this->config_load();
+        } else {
+          this->save_config_cache_();
+          this->publish_queue_stats_();
+        }
+      }
     }
+    return true;
   }
+  return this->lines_received_ != lines_received && this->available() > 0;
 }
 
-int8_t DFRobotC4001Hub::enqueue(std::unique_ptr<Command> cmd, bool first) {
-  return this->cmd_queue_.enqueue(std::move(cmd), first);  // Transfer ownership using std::move
+// called whenever the command queue drains
+void DFRobotC4001Hub::publish_queue_stats_() {
+  if (this->config_save_pending_) {
+    this->config_save_pending_ = false;
+    // a set command that failed left its parameter different from the module
+    if (!this->needs_save_ && this->get_config_changes_().any()) {
+      ESP_LOGW(TAG, "Not all parameters were written, config needs to be saved again");
+      this->set_needs_save(true);
+    }
+    uint32_t duration = millis() - this->ts_config_save_;
+    ESP_LOGD(TAG, "Config saved in %" PRIu32 " ms", duration);
+#ifdef USE_SENSOR
+    if (this->config_save_time_sensor_ != nullptr) {
+      this->config_save_time_sensor_->publish_state(duration);
+    }
+#endif
+  }
+#ifdef USE_SENSOR
+  if (this->command_retries_sensor_ != nullptr) {
+    this->command_retries_sensor_->publish_state(this->command_retries_);
+  }
+#endif
 }
 
 uint8_t DFRobotC4001Hub::read_message_() {
   while (this->available()) {
     uint8_t byte;
     this->read_byte(&byte);
+    ESP_LOGVV(TAG, "Recv byte: %d", byte);
 
-    if (this->read_pos_ == MMWAVE_READ_BUFFER_LENGTH)
-      this->read_pos_ = 0;
-
-    ESP_LOGVV(TAG, "Buffer pos: %u %d", this->read_pos_, byte);
-
-    if (byte == ASCII_CR)
-      continue;
     if (byte >= 0x7F)
       byte = '?';  // needs to be valid utf8 string for log functions.
-    this->read_buffer_[this->read_pos_] = byte;
+    if (byte == '>')
+      this->prompt_seen_ = true;
 
-    if (byte == '>') {
-      this->read_buffer_[++this->read_pos_] = ASCII_LF;
+    LineEvent event = this->line_assembler_.feed(byte);
+    if (event == LINE_NONE) {
+      if (!this->line_assembler_.discarding())
+        this->report_parser_.feed(byte);
+      continue;
     }
-
-    if (this->read_buffer_[this->read_pos_] == ASCII_LF) {
-      this->read_buffer_[this->read_pos_] = 0;
-      this->read_pos_ = 0;
-#ifdef ESPHOME_LOG_HAS_VERBOSE
-      std::string message(this->read_buffer_);
-      if (!(str_startswith(message, "$DFHPD")) && !(str_startswith(message, "$DFDMD")))
-        ESP_LOGV(TAG, "Recv Msg: %s", this->read_buffer_);
-#endif
-      // ESP_LOGV(TAG, "Recv Msg: %s", this->read_buffer_);
-      return true;  // Full message in buffer
+    // the report ends with the line, a truncated one is never published
+    ReportType report = this->report_parser_.finish();
+    if (this->line_assembler_.overflowed()) {
+      ESP_LOGW(TAG, "Discarded line longer than %u bytes (%" PRIu32 " total)", MMWAVE_READ_BUFFER_LENGTH,
+               this->line_assembler_.get_discarded_lines());
+      report = REPORT_NONE;
+    }
+    if (event == LINE_DISCARDED)
+      continue;
+    this->lines_received_++;
+    if (report == REPORT_NONE) {
+      std::string_view line = this->line_assembler_.line();
+      ESP_LOGV(TAG, "Recv Msg: %.*s", (int) line.size(), line.data());
     } else {
-      this->read_pos_++;
+      this->handle_report_(report);
     }
+    return true;  // Full message in buffer
   }
   return false;  // No full message yet
 }
 
+// publishes a report decoded by the report parser
+void DFRobotC4001Hub::handle_report_(ReportType report) {
+  if (!this->first_report_ && this->is_setup_ && report != REPORT_INVALID) {
+    this->first_report_ = true;
+    uint32_t startup_time = millis() - this->ts_setup_;
+    ESP_LOGD(TAG, "First report %" PRIu32 " ms after setup", startup_time);
+#ifdef USE_SENSOR
+    if (this->startup_time_sensor_ != nullptr) {
+      this->startup_time_sensor_->publish_state(startup_time);
+    }
+#endif
+  }
+  switch (report) {
+    case REPORT_PRESENCE:
+      this->set_occupancy(this->report_parser_.occupancy());
+      ESP_LOGV(TAG, "Recv Rpt: Occupancy %s", this->report_parser_.occupancy() ? "Detected" : "Clear");
+      break;
+    case REPORT_TARGET:
+      this->set_target_distance(this->report_parser_.distance());
+      this->set_target_speed(this->report_parser_.speed());
+      this->set_target_energy(this->report_parser_.energy());
+      this->set_occupancy(true);
+      this->tracker_.update(this->report_parser_.distance(), this->report_parser_.speed(), millis());
+      this->publish_tracker_();
+      ESP_LOGV(TAG, "Recv Rpt: Target Detected, Dist=%.3f, Speed=%.3f, Energy=%d", this->report_parser_.distance(),
+               this->report_parser_.speed(), (uint) this->report_parser_.energy());
+      break;
+    case REPORT_NO_TARGET:
+      this->set_target_distance(0.0);
+      this->set_target_speed(0.0);
+      this->set_target_energy(0.0);
+      this->set_occupancy(false);
+      this->tracker_.reset();
+      this->publish_tracker_();
+      ESP_LOGV(TAG, "Recv Rpt: No Target");
+      break;
+    case REPORT_INVALID:
+      ESP_LOGD(TAG, "Error parsing report: %s", this->line_assembler_.data());
+      break;
+    default:
+      break;
+  }
+}
+
+void DFRobotC4001Hub::publish_tracker_() {
+#ifdef USE_BINARY_SENSOR
+  if (this->target_approaching_binary_sensor_ != nullptr) {
+    this->target_approaching_binary_sensor_->publish_state(this->tracker_.approaching());
+  }
+  if (this->target_leaving_binary_sensor_ != nullptr) {
+    this->target_leaving_binary_sensor_->publish_state(this->tracker_.leaving());
+  }
+#endif
+#ifdef USE_SENSOR
+  for (auto &entry : this->time_to_arrival_sensors_) {
+    entry.sensor.publish_state(this->tracker_.time_to_arrival(this->get_arrival_distance_(entry.arrival_distance)));
+  }
+#endif
+}
+
 uint8_t DFRobotC4001Hub::send_cmd_(const char *cmd, uint32_t duration) {
-  // The interval between two commands must be larger than the specified duration (in ms).
-  if (millis() - this->ts_last_cmd_sent_ > duration) {
+  // The previous command has to be terminated by the prompt
+  // or the interval between two commands must be larger than the specified duration (in ms).
+  if (this->prompt_seen_ || millis() - this->ts_last_cmd_sent_ > duration) {
     this->write_str(cmd);
     this->write_byte(ASCII_CR);
     this->write_byte(ASCII_LF);
     this->ts_last_cmd_sent_ = millis();
+    this->prompt_seen_ = false;
     ESP_LOGV(TAG, "Send Cmd: %s", cmd);
     return true;  // Command sent
   }
@@ -580,57 +956,66 @@ uint8_t DFRobotC4001Hub::send_cmd_(const char *cmd, uint32_t duration) {
   return false;
 }
 
-int8_t CircularCommandQueue::enqueue(std::unique_ptr<Command> cmd, bool first) {
-  if (this->is_full()) {
-    ESP_LOGE(TAG, "Command queue is full");
-    return -1;
-  }
-  if (first) {
-    if (this->is_empty())
-      this->rear_ = 0;
-    this->front_ = (this->front_ - 1) % COMMAND_QUEUE_SIZE;
-    this->commands_[this->front_] = std::move(cmd);  // Transfer ownership using std::move
-    return 1;
-  } else {
-    if (this->is_empty())
-      this->front_ = 0;
-    this->rear_ = (this->rear_ + 1) % COMMAND_QUEUE_SIZE;
-    this->commands_[this->rear_] = std::move(cmd);  // Transfer ownership using std::move
-    return 1;
-  }
+CircularCommandQueue::CircularCommandQueue() {
+  for (uint8_t slot = 0; slot < COMMAND_QUEUE_SIZE; slot++)
+    this->free_slots_.push_back(slot);
+}
+
+CircularCommandQueue::~CircularCommandQueue() {
+  while (!this->is_empty())
+    this->dequeue();
+}
+
+int8_t CircularCommandQueue::full_error_() {
+  ESP_LOGE(TAG, "Command queue is full");
+  return -1;
+}
+
+bool CircularCommandQueue::push_(CommandLane lane, bool first, const QueuedCommand &queued) {
+  if (lane == LANE_CONTROL)
+    return first ? this->control_lane_.push_front(queued) : this->control_lane_.push_back(queued);
+  return first ? this->config_lane_.push_front(queued) : this->config_lane_.push_back(queued);
+}
+
+// the command of the first lane that is not empty, nullptr if all lanes are empty
+CircularCommandQueue::QueuedCommand *CircularCommandQueue::front_() {
+  if (!this->control_lane_.empty())
+    return &this->control_lane_.front();
+  if (!this->config_lane_.empty())
+    return &this->config_lane_.front();
+  return nullptr;
 }
 
 bool CircularCommandQueue::is_retry_power_stop() {
-  if (this->is_empty()) {
-    return false;
-  } else {
-    return this->commands_[this->front_]->retry_power_stop;
-  }
+  QueuedCommand *queued = this->front_();
+  return queued != nullptr && queued->command->retry_power_stop;
 }
 
-std::unique_ptr<Command> CircularCommandQueue::dequeue() {
-  if (this->is_empty())
-    return nullptr;
-  std::unique_ptr<Command> dequeued_cmd = std::move(this->commands_[this->front_]);
-  if (this->front_ == this->rear_) {
-    this->front_ = -1;
-    this->rear_ = -1;
+// destroys the command in front, its slot can be reused right away
+void CircularCommandQueue::dequeue() {
+  QueuedCommand *queued = this->front_();
+  if (queued == nullptr)
+    return;
+  uint8_t slot = queued->slot;
+  queued->command->~Command();
+  if (!this->control_lane_.empty()) {
+    this->control_lane_.pop_front();
   } else {
-    this->front_ = (this->front_ + 1) % COMMAND_QUEUE_SIZE;
+    this->config_lane_.pop_front();
   }
-  return dequeued_cmd;
+  this->free_slots_.push_back(slot);
 }
 
-bool CircularCommandQueue::is_empty() { return this->front_ == -1; }
+bool CircularCommandQueue::is_empty() { return this->control_lane_.empty() && this->config_lane_.empty(); }
 
-// queue is full when there is 1 space left
-bool CircularCommandQueue::is_full() { return (this->rear_ + 2) % COMMAND_QUEUE_SIZE == this->front_; }
+bool CircularCommandQueue::is_full() { return this->free_slots_.empty(); }
 
 // Run execute method of first in line command.
 // Execute is non-blocking and has to be called until it returns 1.
 int8_t CircularCommandQueue::process(DFRobotC4001Hub *parent) {
-  if (!is_empty()) {
-    return this->commands_[this->front_]->execute(parent);
+  QueuedCommand *queued = this->front_();
+  if (queued != nullptr) {
+    return queued->command->execute(parent);
   } else {
     return true;
   }
@@ -12,6 +12,9 @@
 #ifdef USE_NUMBER
 #include "esphome/components/number/number.h"
 #endif
+#ifdef USE_SELECT
+#include "esphome/components/select/select.h"
+#endif
 #ifdef USE_SENSOR
 #include "esphome/components/sensor/sensor.h"
 #endif
@@ -24,8 +27,21 @@
 
 #include "esphome/components/uart/uart.h"
 #include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
+
+#include <cmath>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "commands.h"
+#include "fixed_deque.h"
+#include "line_assembler.h"
+#include "motion_tracker.h"
+#include "report_parser.h"
+#include "sensor_with_deadband.h"
 
 namespace esphome {
 namespace dfrobot_c4001 {
@@ -44,27 +60,116 @@ enum DFRobotModel : uint8_t {
 
 const uint8_t MMWAVE_READ_BUFFER_LENGTH = 64;
 
+// module parameters as last read from or written to the module, config_save() only sends what differs
+struct ModuleConfig {
+  float min_range{NAN};
+  float max_range{NAN};
+  float trigger_range{NAN};
+  float hold_sensitivity{NAN};
+  float trigger_sensitivity{NAN};
+  float on_latency{NAN};
+  float off_latency{NAN};
+  float inhibit_time{NAN};
+  float threshold_factor{NAN};
+  uint8_t micro_motion_enable{0xFF};  // 0xFF is unknown
+  uint8_t out_led_enable{0xFF};
+  uint8_t run_led_enable{0xFF};
+};
+
+// parameters whose requested value differs from the module, see DFRobotC4001Hub::get_config_changes_()
+struct ConfigChanges {
+  bool run_led{false};
+  bool out_led{false};
+  bool range{false};
+  bool trigger_range{false};
+  bool sensitivity{false};
+  bool latency{false};
+  bool inhibit_time{false};
+  bool threshold_factor{false};
+  bool micro_motion{false};
+
+  // the RUN led state is not stored by the module, only the other parameters need saveConfig
+  bool needs_module_save() const {
+    return this->out_led || this->range || this->trigger_range || this->sensitivity || this->latency ||
+           this->inhibit_time || this->threshold_factor || this->micro_motion;
+  }
+  bool any() const { return this->run_led || this->needs_module_save(); }
+};
+
+static const uint8_t VERSION_LENGTH = 32;
+
+// module configuration stored in preferences, valid only for the module with the same hardware version
+struct ConfigCache {
+  char hw_version[VERSION_LENGTH];
+  char sw_version[VERSION_LENGTH];
+  ModuleConfig config;
+  uint8_t mode;
+  uint32_t hash;  // over all fields above
+};
+
 static const uint8_t COMMAND_QUEUE_SIZE = 32;
+static const uint8_t CONTROL_LANE_SIZE = 4;
+static const uint8_t MAX_STEPS_PER_LOOP = 8;  // command steps run back to back in one loop while data is ready
+static const size_t COMMAND_SLOT_SIZE = 104;  // largest command object, checked at compile time
 
+// Lanes are processed in order, a lane only runs when all lanes before it are empty.
+// Reading the sensor state is the background work done when all lanes are empty.
+enum CommandLane : uint8_t {
+  LANE_CONTROL = 0,  // recovery commands, e.g. stopping the sensor before a retry
+  LANE_CONFIG,       // command sequences (setup, config load and save, restart)
+};
+
+// Commands are constructed in place in preallocated slots, the queue never touches the heap.
 class CircularCommandQueue {
  public:
-  int8_t enqueue(std::unique_ptr<Command> cmd, bool first = false);
-  std::unique_ptr<Command> dequeue();
+  CircularCommandQueue();
+  ~CircularCommandQueue();
+  template<typename T, typename... Args> int8_t enqueue(CommandLane lane, bool first, Args &&...args) {
+    static_assert(std::is_base_of<Command, T>::value, "T must be a Command");
+    static_assert(sizeof(T) <= COMMAND_SLOT_SIZE, "Command does not fit in a queue slot");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Command alignment exceeds queue slot alignment");
+    if (this->free_slots_.empty())
+      return this->full_error_();
+    uint8_t slot = this->free_slots_.front();
+    QueuedCommand queued{new (this->slots_[slot].data) T(std::forward<Args>(args)...), slot};
+    if (!this->push_(lane, first, queued)) {
+      queued.command->~Command();
+      return this->full_error_();
+    }
+    this->free_slots_.pop_front();
+    return 1;
+  }
+  void dequeue();
   bool is_retry_power_stop();
   bool is_empty();
   bool is_full();
   int8_t process(DFRobotC4001Hub *parent);
 
  protected:
-  int front_{-1};
-  int rear_{-1};
-  std::unique_ptr<Command> commands_[COMMAND_QUEUE_SIZE];
+  struct QueuedCommand {
+    Command *command;
+    uint8_t slot;
+  };
+  struct CommandSlot {
+    alignas(std::max_align_t) uint8_t data[COMMAND_SLOT_SIZE];
+  };
+
+  bool push_(CommandLane lane, bool first, const QueuedCommand &queued);
+  QueuedCommand *front_();
+  int8_t full_error_();
+
+  FixedDeque<QueuedCommand, CONTROL_LANE_SIZE> control_lane_;
+  FixedDeque<QueuedCommand, COMMAND_QUEUE_SIZE> config_lane_;
+  FixedDeque<uint8_t, COMMAND_QUEUE_SIZE> free_slots_;
+  CommandSlot slots_[COMMAND_QUEUE_SIZE];
 };
 
 class DFRobotC4001Hub : public uart::UARTDevice, public Component {
 #ifdef USE_BINARY_SENSOR
   SUB_BINARY_SENSOR(occupancy)
   SUB_BINARY_SENSOR(config_changed)
+  SUB_BINARY_SENSOR(target_approaching)
+  SUB_BINARY_SENSOR(target_leaving)
 #endif
 
 #ifdef USE_BUTTON
@@ -85,10 +190,18 @@ class DFRobotC4001Hub : public uart::UARTDevice, public Component {
   SUB_NUMBER(threshold_factor)
 #endif
 
+#ifdef USE_SELECT
+  SUB_SELECT(mode)
+#endif
+
 #ifdef USE_SENSOR
-  SUB_SENSOR(target_distance)
-  SUB_SENSOR(target_speed)
-  SUB_SENSOR(target_energy)
+  SUB_SENSOR(startup_time)
+  SUB_SENSOR(config_save_time)
+  SUB_SENSOR(command_retries)
+  // distance and energy are 0 without a target, a speed of 0 is a standing target
+  SUB_SENSOR_WITH_DEADBAND(target_distance, true)
+  SUB_SENSOR_WITH_DEADBAND(target_speed, false)
+  SUB_SENSOR_WITH_DEADBAND(target_energy, true)
 #endif
 
 #ifdef USE_SWITCH
@@ -121,10 +234,32 @@ class DFRobotC4001Hub : public uart::UARTDevice, public Component {
   void set_micro_motion_enable(bool enable, bool needs_save = true);
   void flash_run_led_enable();
   void set_mode(DFRobotMode value);
+  DFRobotMode get_mode() const { return this->mode_; }
+  void switch_mode(DFRobotMode mode);
+  bool check_mode(DFRobotMode mode, const char *name);
   void set_model(DFRobotModel value);
   void set_software_version(char *version);
   void set_hardware_version(char *version);
   void set_needs_save(bool needs_save);
+  void set_tracker(float alpha, float beta, float speed_threshold, float arrival_distance) {
+    this->tracker_.set_alpha(alpha);
+    this->tracker_.set_beta(beta);
+    this->tracker_.set_speed_threshold(speed_threshold);
+    this->tracker_.set_arrival_distance(arrival_distance);
+  }
+#ifdef USE_SENSOR
+  // one sensor per arrival distance, NAN uses the tracker arrival_distance
+  void add_time_to_arrival_sensor(sensor::Sensor *sens, float deadband, float arrival_distance) {
+    TimeToArrivalSensor &entry = this->time_to_arrival_sensors_.emplace_back();
+    entry.sensor.set_sensor(sens);
+    entry.sensor.set_deadband(deadband);
+    entry.arrival_distance = arrival_distance;
+  }
+#endif
+  void set_restore_config(const std::string &key) {
+    this->restore_config_ = true;
+    this->config_key_ = fnv1a_hash(key);
+  }
   void setup_module();
   void config_load();
   void config_save();
@@ -134,7 +269,9 @@ class DFRobotC4001Hub : public uart::UARTDevice, public Component {
   void set_target_distance(float value);
   void set_target_speed(float value);
   void set_target_energy(float value);
-  int8_t enqueue(std::unique_ptr<Command> cmd, bool first = false);
+  template<typename T, typename... Args> int8_t enqueue(Args &&...args) {
+    return this->cmd_queue_.enqueue<T>(LANE_CONFIG, false, std::forward<Args>(args)...);
+  }
 
  protected:
   bool is_setup_{false};
@@ -152,9 +289,11 @@ class DFRobotC4001Hub : public uart::UARTDevice, public Component {
   bool run_led_enable_{true};
   bool needs_save_{false};
   bool occupancy_{false};
+  bool occupancy_published_{false};
   float target_distance_;
   float target_speed_;
   float target_energy_;
+  ModuleConfig module_config_;
   DFRobotMode mode_{MODE_PRESENCE};
   DFRobotModel model_{MODEL_UNKNOWN};
   DFRobotModel hw_model_{MODEL_UNKNOWN};
@@ -165,13 +304,47 @@ class DFRobotC4001Hub : public uart::UARTDevice, public Component {
   ESPPreferenceObject pref_;
 #endif
 
-  char read_buffer_[MMWAVE_READ_BUFFER_LENGTH];
-  size_t read_pos_{0};
+  LineAssembler<MMWAVE_READ_BUFFER_LENGTH> line_assembler_;
+  ReportParser report_parser_;
+  MotionTracker tracker_;
   CircularCommandQueue cmd_queue_;
+  ReadStateCommand read_state_cmd_;  // runs whenever the queue is empty
   uint32_t ts_last_cmd_sent_{0};
   int32_t ts_cmd_error_cnt_{0};
+  uint32_t ts_setup_{0};
+  uint32_t lines_received_{0};
+  uint32_t command_retries_{0};
+  uint32_t ts_config_save_{0};
+  bool config_save_pending_{false};  // config_save_time is published when the queue drains
+  bool prompt_seen_{true};  // the previous command was terminated by the prompt, the next can be sent right away
+  bool first_report_{false};
+  bool restore_config_{false};
+  bool verify_config_{false};  // the restored config is confirmed by the hardware version read at boot
+  uint32_t config_key_{0};
+  uint32_t config_saved_hash_{0};
+  ESPPreferenceObject config_pref_;
+#ifdef USE_SENSOR
+  struct TimeToArrivalSensor {
+    SensorWithDeadband sensor;
+    float arrival_distance{NAN};
+  };
+  std::vector<TimeToArrivalSensor> time_to_arrival_sensors_;
+#endif
+  float get_arrival_distance_(float arrival_distance) const {
+    return std::isnan(arrival_distance) ? this->tracker_.get_arrival_distance() : arrival_distance;
+  }
 
+  void load_mode_config_();
+  ConfigChanges get_config_changes_();
+  void enqueue_config_changes_(const ConfigChanges &changes);
+  bool process_step_();
+  ConfigCache get_config_cache_();
+  bool restore_config_cache_();
+  void save_config_cache_();
+  void publish_queue_stats_();
   uint8_t read_message_();
+  void handle_report_(ReportType report);
+  void publish_tracker_();
   uint8_t send_cmd_(const char *cmd, uint32_t duration);
 
   friend class Command;
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+
+namespace esphome {
+namespace dfrobot_c4001 {
+
+// Fixed capacity double ended queue on a ring buffer, never touches the heap.
+// Has no ESPHome dependencies so it can be built and tested on the host.
+template<typename T, size_t N> class FixedDeque {
+  static_assert(N > 0, "FixedDeque needs a capacity");
+
+ public:
+  bool empty() const { return this->count_ == 0; }
+  bool full() const { return this->count_ == N; }
+  size_t size() const { return this->count_; }
+  static constexpr size_t capacity() { return N; }
+
+  // returns false if the deque is full
+  bool push_back(const T &value) {
+    if (this->full())
+      return false;
+    this->items_[(this->head_ + this->count_) % N] = value;
+    this->count_++;
+    return true;
+  }
+  // returns false if the deque is full
+  bool push_front(const T &value) {
+    if (this->full())
+      return false;
+    // step back without going negative
+    this->head_ = (this->head_ + N - 1) % N;
+    this->items_[this->head_] = value;
+    this->count_++;
+    return true;
+  }
+  void pop_front() {
+    if (this->empty())
+      return;
+    this->head_ = (this->head_ + 1) % N;
+    this->count_--;
+  }
+  void pop_back() {
+    if (this->empty())
+      return;
+    this->count_--;
+  }
+  void clear() {
+    this->head_ = 0;
+    this->count_ = 0;
+  }
+
+  // element access is undefined on an empty deque
+  T &front() { return this->items_[this->head_]; }
+  const T &front() const { return this->items_[this->head_]; }
+  T &back() { return this->items_[(this->head_ + this->count_ - 1) % N]; }
+  const T &back() const { return this->items_[(this->head_ + this->count_ - 1) % N]; }
+  T &operator[](size_t index) { return this->items_[(this->head_ + index) % N]; }
+  const T &operator[](size_t index) const { return this->items_[(this->head_ + index) % N]; }
+
+ protected:
+  T items_[N]{};
+  size_t head_{0};
+  size_t count_{0};
+};
+
+}  // namespace dfrobot_c4001
+}  // namespace esphome
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace esphome {
+namespace dfrobot_c4001 {
+
+// Result of feeding one byte to the line assembler
+enum LineEvent : uint8_t {
+  LINE_NONE = 0,   // line not complete yet
+  LINE_COMPLETE,   // line() holds the complete line
+  LINE_DISCARDED,  // LF ending a line that did not fit and was dropped
+};
+
+// Assembles the module output into lines, one byte at a time.
+// A line ends with LF or with the '>' of the "DFRobot:/>" prompt, which is not followed by a line feed.
+// A line longer than N is never truncated or spliced with the next one, the rest of it is dropped up to its end.
+// An end byte always ends a line: LF after an overflow reports the line as discarded,
+// '>' still completes a line holding only the '>' so the prompt is never lost.
+// Has no ESPHome dependencies so it can be built and tested on the host.
+template<size_t N> class LineAssembler {
+  static_assert(N > 0, "LineAssembler needs a capacity");
+
+ public:
+  LineEvent feed(char c) {
+    if (c == '\r')
+      return LINE_NONE;
+    if (c != '\n' && c != '>') {
+      if (this->discarding_)
+        return LINE_NONE;
+      if (this->length_ == N) {
+        // too long, drop it up to its end
+        this->discarding_ = true;
+        this->length_ = 0;
+        return LINE_NONE;
+      }
+      this->buffer_[this->length_++] = c;
+      return LINE_NONE;
+    }
+    this->overflowed_ = this->discarding_;
+    if (this->discarding_) {
+      this->discarding_ = false;
+      this->discarded_lines_++;
+      if (c == '\n')
+        return LINE_DISCARDED;
+    }
+    // the prompt terminator is part of the line, the buffer always has room for it
+    if (c == '>')
+      this->buffer_[this->length_++] = c;
+    this->buffer_[this->length_] = 0;
+    this->line_ = std::string_view(this->buffer_, this->length_);
+    this->length_ = 0;
+    return LINE_COMPLETE;
+  }
+
+  // true while the rest of a too long line is dropped
+  bool discarding() const { return this->discarding_; }
+  // true if the last line ended or completed after an overflow, its text was dropped
+  bool overflowed() const { return this->overflowed_; }
+  uint32_t get_discarded_lines() const { return this->discarded_lines_; }
+
+  // the last complete line, valid until the next byte is fed
+  std::string_view line() const { return this->line_; }
+  // the last complete line, null terminated, can be modified in place (e.g. by strtok) until the next byte is fed
+  char *data() { return this->buffer_; }
+
+ protected:
+  char buffer_[N + 2]{};  // N characters, the prompt terminator and the null
+  std::string_view line_{};
+  size_t length_{0};
+  uint32_t discarded_lines_{0};
+  bool discarding_{false};
+  bool overflowed_{false};
+};
+
+}  // namespace dfrobot_c4001
+}  // namespace esphome
@@ -0,0 +1,50 @@
+#include "motion_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace dfrobot_c4001 {
+
+static const float MIN_INTERVAL = 0.01f;  // s, guards the velocity correction against back to back reports
+static const float MAX_INTERVAL = 1.0f;   // s, longer gaps restart the track
+
+void MotionTracker::update(float distance, float speed, uint32_t now) {
+  float dt = (now - this->last_update_) / 1000.0f;
+  this->last_update_ = now;
+  if (!this->tracking_ || dt > MAX_INTERVAL) {
+    this->tracking_ = true;
+    this->distance_ = distance;
+    this->velocity_ = speed;
+  } else {
+    dt = std::max(dt, MIN_INTERVAL);
+    // predict, then correct distance and velocity by the distance residual
+    this->distance_ += this->velocity_ * dt;
+    float residual = distance - this->distance_;
+    this->distance_ += this->alpha_ * residual;
+    this->velocity_ += this->beta_ * residual / dt;
+    // the reported speed is a direct velocity measurement
+    this->velocity_ += this->alpha_ * (speed - this->velocity_);
+  }
+
+  // half the threshold to release avoids toggling around it
+  float release = this->speed_threshold_ / 2;
+  this->approaching_ = this->velocity_ < -(this->approaching_ ? release : this->speed_threshold_);
+  this->leaving_ = this->velocity_ > (this->leaving_ ? release : this->speed_threshold_);
+}
+
+void MotionTracker::reset() {
+  this->tracking_ = false;
+  this->approaching_ = false;
+  this->leaving_ = false;
+  this->velocity_ = 0.0f;
+}
+
+float MotionTracker::time_to_arrival(float arrival_distance) const {
+  if (!this->approaching_ || this->distance_ <= arrival_distance)
+    return NAN;
+  return (this->distance_ - arrival_distance) / -this->velocity_;
+}
+
+}  // namespace dfrobot_c4001
+}  // namespace esphome
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace dfrobot_c4001 {
+
+// Alpha-beta tracker fusing the reported distance and speed of the target into a smoothed distance and velocity.
+// Velocity is negative while the target approaches the sensor.
+class MotionTracker {
+ public:
+  void set_alpha(float alpha) { this->alpha_ = alpha; }
+  void set_beta(float beta) { this->beta_ = beta; }
+  void set_speed_threshold(float speed_threshold) { this->speed_threshold_ = speed_threshold; }
+  void set_arrival_distance(float arrival_distance) { this->arrival_distance_ = arrival_distance; }
+  float get_arrival_distance() const { return this->arrival_distance_; }
+
+  void update(float distance, float speed, uint32_t now);
+  void reset();
+
+  bool is_tracking() const { return this->tracking_; }
+  float distance() const { return this->distance_; }
+  float velocity() const { return this->velocity_; }
+  bool approaching() const { return this->approaching_; }
+  bool leaving() const { return this->leaving_; }
+  // seconds until arrival_distance is reached at the current velocity, NAN if not approaching it
+  float time_to_arrival(float arrival_distance) const;
+
+ protected:
+  float alpha_{0.5f};
+  float beta_{0.1f};
+  float speed_threshold_{0.2f};   // m/s
+  float arrival_distance_{1.0f};  // m, default for time to arrival sensors without their own distance
+  float distance_{0.0f};
+  float velocity_{0.0f};
+  uint32_t last_update_{0};
+  bool tracking_{false};
+  bool approaching_{false};
+  bool leaving_{false};
+};
+
+}  // namespace dfrobot_c4001
+}  // namespace esphome
@@ -4,12 +4,54 @@ namespace esphome {
 namespace dfrobot_c4001 {
 void MaxRangeNumber::control(float value) { this->parent_->set_max_range(value); }
 void MinRangeNumber::control(float value) { this->parent_->set_min_range(value); };
-void TriggerRangeNumber::control(float value) { this->parent_->set_trigger_range(value); };
-void HoldSensitivityNumber::control(float value) { this->parent_->set_hold_sensitivity(value); };
-void TriggerSensitivityNumber::control(float value) { this->parent_->set_trigger_sensitivity(value); };
-void OnLatencyNumber::control(float value) { this->parent_->set_on_latency(value); }
-void OffLatencyNumber::control(float value) { this->parent_->set_off_latency(value); }
-void InhibitTimeNumber::control(float value) { this->parent_->set_inhibit_time(value); }
-void ThresholdFactorNumber::control(float value) { this->parent_->set_threshold_factor(value); }
+void TriggerRangeNumber::control(float value) {
+  if (this->parent_->check_mode(MODE_PRESENCE, "Trigger range")) {
+    this->parent_->set_trigger_range(value);
+  } else {
+    this->publish_state(this->state);
+  }
+}
+void HoldSensitivityNumber::control(float value) {
+  if (this->parent_->check_mode(MODE_PRESENCE, "Hold sensitivity")) {
+    this->parent_->set_hold_sensitivity(value);
+  } else {
+    this->publish_state(this->state);
+  }
+}
+void TriggerSensitivityNumber::control(float value) {
+  if (this->parent_->check_mode(MODE_PRESENCE, "Trigger sensitivity")) {
+    this->parent_->set_trigger_sensitivity(value);
+  } else {
+    this->publish_state(this->state);
+  }
+}
+void OnLatencyNumber::control(float value) {
+  if (this->parent_->check_mode(MODE_PRESENCE, "On latency")) {
+    this->parent_->set_on_latency(value);
+  } else {
+    this->publish_state(this->state);
+  }
+}
+void OffLatencyNumber::control(float value) {
+  if (this->parent_->check_mode(MODE_PRESENCE, "Off latency")) {
+    this->parent_->set_off_latency(value);
+  } else {
+    this->publish_state(this->state);
+  }
+}
+void InhibitTimeNumber::control(float value) {
+  if (this->parent_->check_mode(MODE_PRESENCE, "Inhibit time")) {
+    this->parent_->set_inhibit_time(value);
+  } else {
+    this->publish_state(this->state);
+  }
+}
+void ThresholdFactorNumber::control(float value) {
+  if (this->parent_->check_mode(MODE_SPEED_AND_DISTANCE, "Threshold factor")) {
+    this->parent_->set_threshold_factor(value);
+  } else {
+    this->publish_state(this->state);
+  }
+}
 }  // namespace dfrobot_c4001
 }  // namespace esphome
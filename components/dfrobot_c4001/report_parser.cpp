@@ -0,0 +1,98 @@
+#include "report_parser.h"
+
+namespace esphome {
+namespace dfrobot_c4001 {
+
+static const char PRESENCE_PREFIX[] = "$DFHPD,";
+static const char MOTION_PREFIX[] = "$DFDMD,";
+static const uint8_t MAX_DIGITS = 9;  // keeps the mantissa within int32_t
+static const float POW10[] = {1.0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f};
+
+void ReportParser::feed(char c) {
+  if (this->type_ == TYPE_OTHER)
+    return;
+
+  if (this->prefix_pos_ < PREFIX_LENGTH) {
+    // both prefixes share "$DF", the 4th character decides
+    if (this->prefix_pos_ == 3) {
+      this->type_ = c == PRESENCE_PREFIX[3] ? TYPE_PRESENCE : c == MOTION_PREFIX[3] ? TYPE_MOTION : TYPE_OTHER;
+    }
+    const char *prefix = this->type_ == TYPE_MOTION ? MOTION_PREFIX : PRESENCE_PREFIX;
+    if (c != prefix[this->prefix_pos_]) {
+      this->type_ = TYPE_OTHER;
+      return;
+    }
+    this->prefix_pos_++;
+    return;
+  }
+
+  if (this->field_ >= MAX_FIELDS)
+    return;
+
+  if (c == ',') {
+    this->end_field_();
+  } else if (c >= '0' && c <= '9') {
+    if (this->digits_ == MAX_DIGITS) {
+      this->field_error_ = true;
+      return;
+    }
+    this->mantissa_ = this->mantissa_ * 10 + (c - '0');
+    this->digits_++;
+    if (this->fraction_)
+      this->fraction_digits_++;
+  } else if (c == '.' && !this->fraction_) {
+    this->fraction_ = true;
+  } else if (c == '-' && this->digits_ == 0 && !this->negative_) {
+    this->negative_ = true;
+  } else if (c != ' ' && c != '*' && c != '\r') {
+    this->field_error_ = true;
+  }
+}
+
+void ReportParser::end_field_() {
+  if (this->digits_ > 0 && !this->field_error_) {
+    float value = this->mantissa_ / POW10[this->fraction_digits_];
+    this->values_[this->field_] = this->negative_ ? -value : value;
+    this->valid_fields_ |= 1 << this->field_;
+  }
+  this->field_++;
+  this->mantissa_ = 0;
+  this->digits_ = 0;
+  this->fraction_digits_ = 0;
+  this->negative_ = false;
+  this->fraction_ = false;
+  this->field_error_ = false;
+}
+
+ReportType ReportParser::finish() {
+  ReportType result = REPORT_NONE;
+  if (this->is_report()) {
+    if (this->field_ < MAX_FIELDS)
+      this->end_field_();
+    if (this->type_ == TYPE_PRESENCE) {
+      result = this->has_fields_(1 << 1) ? REPORT_PRESENCE : REPORT_INVALID;
+    } else if (!this->has_fields_(1 << 1)) {
+      result = REPORT_INVALID;
+    } else if (this->values_[1] == 0) {
+      result = REPORT_NO_TARGET;
+    } else {
+      // one target is all this sensor can detect
+      result = this->has_fields_((1 << 3) | (1 << 4) | (1 << 5)) ? REPORT_TARGET : REPORT_INVALID;
+    }
+  }
+  // decoded values stay readable until the next report ends
+  this->prefix_pos_ = 0;
+  this->field_ = 1;
+  this->valid_fields_ = 0;
+  this->type_ = TYPE_UNKNOWN;
+  this->mantissa_ = 0;
+  this->digits_ = 0;
+  this->fraction_digits_ = 0;
+  this->negative_ = false;
+  this->fraction_ = false;
+  this->field_error_ = false;
+  return result;
+}
+
+}  // namespace dfrobot_c4001
+}  // namespace esphome
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace dfrobot_c4001 {
+
+// Result of a decoded report line
+enum ReportType : uint8_t {
+  REPORT_NONE = 0,   // not a report, e.g. a command response
+  REPORT_PRESENCE,   // $DFHPD, occupancy() is valid
+  REPORT_TARGET,     // $DFDMD with one target, distance(), speed() and energy() are valid
+  REPORT_NO_TARGET,  // $DFDMD without target
+  REPORT_INVALID,    // report with missing or malformed fields
+};
+
+// Decodes $DFHPD and $DFDMD reports one byte at a time while the line is received.
+// Fields are accumulated as fixed-point numbers, nothing is copied and there is no second pass over the line.
+// Spaces, the '*' end marker and CR are ignored, so the raw module output can be fed.
+// Has no ESPHome dependencies so it can be built and tested on the host.
+class ReportParser {
+ public:
+  void feed(char c);
+  // call at the end of every line, also prepares the parser for the next line
+  ReportType finish();
+  // true once the line start has been recognized as a report
+  bool is_report() const { return this->type_ != TYPE_OTHER && this->prefix_pos_ == PREFIX_LENGTH; }
+
+  bool occupancy() const { return this->values_[1] != 0; }
+  float distance() const { return this->values_[3]; }
+  float speed() const { return this->values_[4]; }
+  float energy() const { return this->values_[5]; }
+
+ protected:
+  enum LineType : uint8_t {
+    TYPE_UNKNOWN = 0,
+    TYPE_PRESENCE,
+    TYPE_MOTION,
+    TYPE_OTHER,
+  };
+  static const uint8_t PREFIX_LENGTH = 7;  // "$DFHPD," or "$DFDMD,"
+  static const uint8_t MAX_FIELDS = 6;     // fields past the energy are not used
+
+  void end_field_();
+  bool has_fields_(uint8_t mask) const { return (this->valid_fields_ & mask) == mask; }
+
+  float values_[MAX_FIELDS]{};
+  int32_t mantissa_{0};
+  uint8_t prefix_pos_{0};
+  uint8_t field_{1};  // field 0 is the prefix
+  uint8_t digits_{0};
+  uint8_t fraction_digits_{0};
+  uint8_t valid_fields_{0};
+  LineType type_{TYPE_UNKNOWN};
+  bool negative_{false};
+  bool fraction_{false};
+  bool field_error_{false};
+};
+
+}  // namespace dfrobot_c4001
+}  // namespace esphome
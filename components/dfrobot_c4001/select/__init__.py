@@ -0,0 +1,40 @@
+import esphome.codegen as cg
+from esphome.components import select
+import esphome.config_validation as cv
+from esphome.const import CONF_MODE, ENTITY_CATEGORY_CONFIG
+
+from .. import (
+    CONF_DFROBOT_C4001_ID,
+    CONF_MODE_ENUM,
+    HUB_CHILD_SCHEMA,
+    dfrobot_c4001_ns,
+)
+
+DEPENDENCIES = ["dfrobot_c4001"]
+
+ICON_RADAR = "mdi:radar"
+
+ModeSelect = dfrobot_c4001_ns.class_("ModeSelect", select.Select)
+
+CONFIG_SCHEMA = (
+    cv.Schema(
+        {
+            cv.Optional(CONF_MODE): select.select_schema(
+                ModeSelect,
+                entity_category=ENTITY_CATEGORY_CONFIG,
+                icon=ICON_RADAR,
+            ),
+        }
+    )
+    .extend(HUB_CHILD_SCHEMA)
+    .extend(cv.COMPONENT_SCHEMA)
+)
+
+
+async def to_code(config):
+    dfrobot_c4001_hub = await cg.get_variable(config[CONF_DFROBOT_C4001_ID])
+
+    if mode := config.get(CONF_MODE):
+        sel = await select.new_select(mode, options=list(CONF_MODE_ENUM))
+        await cg.register_parented(sel, config[CONF_DFROBOT_C4001_ID])
+        cg.add(dfrobot_c4001_hub.set_mode_select(sel))
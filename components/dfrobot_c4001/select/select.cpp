@@ -0,0 +1,8 @@
+#include "select.h"
+
+namespace esphome {
+namespace dfrobot_c4001 {
+// the options are in DFRobotMode order, the hub publishes the new state
+void ModeSelect::control(size_t index) { this->parent_->switch_mode(static_cast<DFRobotMode>(index)); }
+}  // namespace dfrobot_c4001
+}  // namespace esphome
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "esphome/components/select/select.h"
+
+#include "../dfrobot_c4001.h"
+
+namespace esphome {
+namespace dfrobot_c4001 {
+class ModeSelect : public select::Select, public Parented<DFRobotC4001Hub> {
+ protected:
+  void control(size_t index) override;
+};
+}  // namespace dfrobot_c4001
+}  // namespace esphome
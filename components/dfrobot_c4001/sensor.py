@@ -6,48 +6,111 @@ import esphome.config_validation as cv
 from esphome.const import (
     CONF_MODE,
     DEVICE_CLASS_DISTANCE,
+    DEVICE_CLASS_DURATION,
     DEVICE_CLASS_ENERGY,
     DEVICE_CLASS_SPEED,
+    ENTITY_CATEGORY_DIAGNOSTIC,
     STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
     UNIT_EMPTY,
     UNIT_METER,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
 )
 import esphome.final_validate as fv
 
-from . import CONF_DFROBOT_C4001_ID, HUB_CHILD_SCHEMA
+from . import (
+    CONF_ARRIVAL_DISTANCE,
+    CONF_DFROBOT_C4001_ID,
+    HUB_CHILD_SCHEMA,
+    mode_select_configured,
+)
 
+CONF_STARTUP_TIME = "startup_time"
+CONF_CONFIG_SAVE_TIME = "config_save_time"
+CONF_COMMAND_RETRIES = "command_retries"
 CONF_TARGET_DISTANCE = "target_distance"
 CONF_TARGET_SPEED = "target_speed"
 CONF_TARGET_ENERGY = "target_energy"
+CONF_TIME_TO_ARRIVAL = "time_to_arrival"
+CONF_DEADBAND = "deadband"
 UNIT_METERS_PER_SECOND = "m/s"
 
+ICON_TIMER = "mdi:timer-outline"
+ICON_TIMER_SAND = "mdi:timer-sand"
+ICON_REPLAY = "mdi:replay"
 ICON_USBC = "mdi:usb-c-port"
 
 DEPENDENCIES = ["dfrobot_c4001"]
 
+# values within the deadband of the last published one are not published again
+DEADBAND_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_DEADBAND, default=0): cv.positive_float,
+    }
+)
+
 CONFIG_SCHEMA = (
     cv.Schema(
         {
+            cv.Optional(CONF_STARTUP_TIME): sensor.sensor_schema(
+                icon=ICON_TIMER,
+                accuracy_decimals=0,
+                unit_of_measurement=UNIT_MILLISECOND,
+                device_class=DEVICE_CLASS_DURATION,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_CONFIG_SAVE_TIME): sensor.sensor_schema(
+                icon=ICON_TIMER,
+                accuracy_decimals=0,
+                unit_of_measurement=UNIT_MILLISECOND,
+                device_class=DEVICE_CLASS_DURATION,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_COMMAND_RETRIES): sensor.sensor_schema(
+                icon=ICON_REPLAY,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
             cv.Optional(CONF_TARGET_DISTANCE): sensor.sensor_schema(
                 icon=ICON_USBC,
                 accuracy_decimals=2,
                 unit_of_measurement=UNIT_METER,
                 state_class=STATE_CLASS_MEASUREMENT,
                 device_class=DEVICE_CLASS_DISTANCE,
-            ),
+            ).extend(DEADBAND_SCHEMA),
             cv.Optional(CONF_TARGET_SPEED): sensor.sensor_schema(
                 icon=ICON_USBC,
                 accuracy_decimals=2,
                 unit_of_measurement=UNIT_METERS_PER_SECOND,
                 state_class=STATE_CLASS_MEASUREMENT,
                 device_class=DEVICE_CLASS_SPEED,
-            ),
+            ).extend(DEADBAND_SCHEMA),
             cv.Optional(CONF_TARGET_ENERGY): sensor.sensor_schema(
                 icon=ICON_USBC,
                 accuracy_decimals=0,
                 unit_of_measurement=UNIT_EMPTY,
                 state_class=STATE_CLASS_MEASUREMENT,
                 device_class=DEVICE_CLASS_ENERGY,
+            ).extend(DEADBAND_SCHEMA),
+            # one sensor or a list of sensors, each for its own arrival distance
+            cv.Optional(CONF_TIME_TO_ARRIVAL): cv.ensure_list(
+                sensor.sensor_schema(
+                    icon=ICON_TIMER_SAND,
+                    accuracy_decimals=1,
+                    unit_of_measurement=UNIT_SECOND,
+                    state_class=STATE_CLASS_MEASUREMENT,
+                    device_class=DEVICE_CLASS_DURATION,
+                )
+                .extend(DEADBAND_SCHEMA)
+                .extend(
+                    {
+                        cv.Optional(CONF_ARRIVAL_DISTANCE): cv.All(
+                            cv.distance, cv.Range(min=0.0, max=25.0)
+                        ),
+                    }
+                )
             ),
         }
     )
@@ -58,6 +121,9 @@ CONFIG_SCHEMA = (
 
 def _final_validate(config):
     full_config = fv.full_config.get()
+    if mode_select_configured(full_config, config[CONF_DFROBOT_C4001_ID]):
+        # entities of both modes can be used when the mode is switched at runtime
+        return
     hub_path = full_config.get_path_for_id(config[CONF_DFROBOT_C4001_ID])[:-1]
     hub_conf = full_config.get_config_for_path(hub_path)
     MODE = hub_conf.get(CONF_MODE)
@@ -74,6 +140,10 @@ def _final_validate(config):
             raise cv.Invalid(
                 f"When 'mode' is set to {MODE}, {CONF_TARGET_ENERGY} sensor is not allowed."
             )
+        if CONF_TIME_TO_ARRIVAL in config:
+            raise cv.Invalid(
+                f"When 'mode' is set to {MODE}, {CONF_TIME_TO_ARRIVAL} sensor is not allowed."
+            )
 
 
 FINAL_VALIDATE_SCHEMA = _final_validate
@@ -82,12 +152,35 @@ FINAL_VALIDATE_SCHEMA = _final_validate
 async def to_code(config):
     dfrobot_c4001_hub = await cg.get_variable(config[CONF_DFROBOT_C4001_ID])
 
+    if startup_time := config.get(CONF_STARTUP_TIME):
+        sens = await sensor.new_sensor(startup_time)
+        cg.add(dfrobot_c4001_hub.set_startup_time_sensor(sens))
+    if config_save_time := config.get(CONF_CONFIG_SAVE_TIME):
+        sens = await sensor.new_sensor(config_save_time)
+        cg.add(dfrobot_c4001_hub.set_config_save_time_sensor(sens))
+    if command_retries := config.get(CONF_COMMAND_RETRIES):
+        sens = await sensor.new_sensor(command_retries)
+        cg.add(dfrobot_c4001_hub.set_command_retries_sensor(sens))
     if target_distance := config.get(CONF_TARGET_DISTANCE):
         sens = await sensor.new_sensor(target_distance)
         cg.add(dfrobot_c4001_hub.set_target_distance_sensor(sens))
+        cg.add(dfrobot_c4001_hub.set_target_distance_deadband(target_distance[CONF_DEADBAND]))
     if target_speed := config.get(CONF_TARGET_SPEED):
         sens = await sensor.new_sensor(target_speed)
         cg.add(dfrobot_c4001_hub.set_target_speed_sensor(sens))
+        cg.add(dfrobot_c4001_hub.set_target_speed_deadband(target_speed[CONF_DEADBAND]))
     if target_energy := config.get(CONF_TARGET_ENERGY):
         sens = await sensor.new_sensor(target_energy)
         cg.add(dfrobot_c4001_hub.set_target_energy_sensor(sens))
+        cg.add(dfrobot_c4001_hub.set_target_energy_deadband(target_energy[CONF_DEADBAND]))
+    for time_to_arrival in config.get(CONF_TIME_TO_ARRIVAL, []):
+        sens = await sensor.new_sensor(time_to_arrival)
+        # without its own distance the tracker arrival_distance is used
+        arrival_distance = time_to_arrival.get(
+            CONF_ARRIVAL_DISTANCE, cg.RawExpression("NAN")
+        )
+        cg.add(
+            dfrobot_c4001_hub.add_time_to_arrival_sensor(
+                sens, time_to_arrival[CONF_DEADBAND], arrival_distance
+            )
+        )
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_SENSOR
+#include <cmath>
+
+#include "esphome/components/sensor/sensor.h"
+
+namespace esphome {
+namespace dfrobot_c4001 {
+
+// Sensor publishing only when the value moved by more than the deadband, the same value is never published twice.
+// With zero_bypass changes to and from 0 are always published, for values where 0 means the module lost the target.
+class SensorWithDeadband {
+ public:
+  explicit SensorWithDeadband(bool zero_bypass = false) : zero_bypass_(zero_bypass) {}
+  void set_sensor(sensor::Sensor *sens) { this->sens_ = sens; }
+  void set_deadband(float deadband) { this->deadband_ = deadband; }
+  sensor::Sensor *get_sensor() const { return this->sens_; }
+
+  void publish_state(float value) {
+    if (this->sens_ == nullptr)
+      return;
+    if (this->published_) {
+      if (std::isnan(value) && std::isnan(this->last_))
+        return;
+      if (!std::isnan(value) && !std::isnan(this->last_) &&
+          (!this->zero_bypass_ || (value == 0) == (this->last_ == 0)) &&
+          std::fabs(value - this->last_) <= this->deadband_)
+        return;
+    }
+    this->published_ = true;
+    this->last_ = value;
+    this->sens_->publish_state(value);
+  }
+
+ protected:
+  sensor::Sensor *sens_{nullptr};
+  float deadband_{0.0f};
+  float last_{NAN};
+  bool published_{false};
+  bool zero_bypass_;
+};
+
+#define SUB_SENSOR_WITH_DEADBAND(name, zero_bypass) \
+ protected: \
+  SensorWithDeadband name##_sensor_{zero_bypass}; \
+\
+ public: \
+  void set_##name##_sensor(sensor::Sensor *sensor) { this->name##_sensor_.set_sensor(sensor); } \
+  void set_##name##_deadband(float deadband) { this->name##_sensor_.set_deadband(deadband); }
+
+}  // namespace dfrobot_c4001
+}  // namespace esphome
+#endif
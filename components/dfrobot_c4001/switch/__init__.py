@@ -9,7 +9,12 @@ from esphome.const import (
 )
 import esphome.final_validate as fv
 
-from .. import CONF_DFROBOT_C4001_ID, HUB_CHILD_SCHEMA, dfrobot_c4001_ns
+from .. import (
+    CONF_DFROBOT_C4001_ID,
+    HUB_CHILD_SCHEMA,
+    dfrobot_c4001_ns,
+    mode_select_configured,
+)
 
 DEPENDENCIES = ["dfrobot_c4001"]
 
@@ -54,6 +59,9 @@ CONFIG_SCHEMA = (
 
 def _final_validate(config):
     full_config = fv.full_config.get()
+    if mode_select_configured(full_config, config[CONF_DFROBOT_C4001_ID]):
+        # entities of both modes can be used when the mode is switched at runtime
+        return
     hub_path = full_config.get_path_for_id(config[CONF_DFROBOT_C4001_ID])[:-1]
     hub_conf = full_config.get_config_for_path(hub_path)
     mode = hub_conf.get(CONF_MODE)
@@ -4,6 +4,12 @@ namespace esphome {
 namespace dfrobot_c4001 {
 void OutLedSwitch::write_state(bool state) { this->parent_->set_out_led_enable(state); }
 void RunLedSwitch::write_state(bool state) { this->parent_->set_run_led_enable(state); }
-void MicroMotionSwitch::write_state(bool state) { this->parent_->set_micro_motion_enable(state); }
+void MicroMotionSwitch::write_state(bool state) {
+  if (this->parent_->check_mode(MODE_SPEED_AND_DISTANCE, "Micro motion")) {
+    this->parent_->set_micro_motion_enable(state);
+  } else {
+    this->publish_state(this->state);
+  }
+}
 }  // namespace dfrobot_c4001
 }  // namespace esphome
\ No newline at end of file
@@ -1,3 +1,5 @@
+from esphome import automation
+from esphome.automation import maybe_simple_id
 import esphome.codegen as cg
 from esphome.components import uart
 import esphome.config_validation as cv
@@ -13,12 +15,32 @@ MULTI_CONF = True
 ld2410s_ns = cg.esphome_ns.namespace("ld2410s")
 LD2410SComponent = ld2410s_ns.class_("LD2410SComponent", cg.Component, uart.UARTDevice)
 
+# Actions
+SuggestThresholdsAction = ld2410s_ns.class_("SuggestThresholdsAction", automation.Action)
+ApplySuggestedThresholdsAction = ld2410s_ns.class_(
+    "ApplySuggestedThresholdsAction", automation.Action
+)
+ResetNoiseStatsAction = ld2410s_ns.class_("ResetNoiseStatsAction", automation.Action)
+DumpHistoryAction = ld2410s_ns.class_("DumpHistoryAction", automation.Action)
+
+CONF_HISTORY_SIZE = "history_size"
+CONF_HOLD_MARGIN = "hold_margin"
 CONF_LD2410S_ID = "ld2410s_id"
+CONF_NOISE_STATISTICS = "noise_statistics"
+CONF_RESTORE_CONFIG = "restore_config"
+CONF_RX_POLL_INTERVAL = "rx_poll_interval"
+CONF_STATS_INTERVAL = "stats_interval"
+CONF_TRIGGER_MARGIN = "trigger_margin"
 
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(LD2410SComponent),
+            cv.Optional(CONF_HISTORY_SIZE): cv.int_range(min=1, max=1000),
+            cv.Optional(CONF_NOISE_STATISTICS, default=False): cv.boolean,
+            cv.Optional(CONF_RESTORE_CONFIG, default=False): cv.boolean,
+            cv.Optional(CONF_RX_POLL_INTERVAL): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_STATS_INTERVAL): cv.positive_time_period_milliseconds,
         }
     )
     .extend(uart.UART_DEVICE_SCHEMA)
@@ -38,3 +60,69 @@ async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
     await uart.register_uart_device(var, config)
+    if history_size := config.get(CONF_HISTORY_SIZE):
+        cg.add(var.set_history_size(history_size))
+    if config[CONF_NOISE_STATISTICS]:
+        cg.add(var.set_noise_stats(True))
+    if config[CONF_RESTORE_CONFIG]:
+        cg.add(var.set_restore_config(f"ld2410s.{config[CONF_ID]}"))
+    if rx_poll_interval := config.get(CONF_RX_POLL_INTERVAL):
+        cg.add(var.set_rx_poll_interval(rx_poll_interval))
+    if stats_interval := config.get(CONF_STATS_INTERVAL):
+        cg.add(var.set_stats_interval(stats_interval))
+
+
+LD2410S_ACTION_SCHEMA = maybe_simple_id({cv.GenerateID(): cv.use_id(LD2410SComponent)})
+
+
+@automation.register_action(
+    "ld2410s.dump_history",
+    DumpHistoryAction,
+    LD2410S_ACTION_SCHEMA,
+    synchronous=False,
+)
+@automation.register_action(
+    "ld2410s.reset_noise_statistics",
+    ResetNoiseStatsAction,
+    LD2410S_ACTION_SCHEMA,
+    synchronous=False,
+)
+async def ld2410s_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+
+LD2410S_THRESHOLDS_ACTION_SCHEMA = maybe_simple_id(
+    {
+        cv.GenerateID(): cv.use_id(LD2410SComponent),
+        cv.Optional(CONF_TRIGGER_MARGIN, default=6): cv.templatable(
+            cv.int_range(min=0, max=50)
+        ),
+        cv.Optional(CONF_HOLD_MARGIN, default=3): cv.templatable(
+            cv.int_range(min=0, max=50)
+        ),
+    }
+)
+
+
+@automation.register_action(
+    "ld2410s.suggest_thresholds",
+    SuggestThresholdsAction,
+    LD2410S_THRESHOLDS_ACTION_SCHEMA,
+    synchronous=False,
+)
+@automation.register_action(
+    "ld2410s.apply_suggested_thresholds",
+    ApplySuggestedThresholdsAction,
+    LD2410S_THRESHOLDS_ACTION_SCHEMA,
+    synchronous=False,
+)
+async def ld2410s_thresholds_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    template = await cg.templatable(config[CONF_TRIGGER_MARGIN], args, cg.uint8)
+    cg.add(var.set_trigger_margin(template))
+    template = await cg.templatable(config[CONF_HOLD_MARGIN], args, cg.uint8)
+    cg.add(var.set_hold_margin(template))
+    return var
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/automation.h"
+#include "ld2410s.h"
+
+namespace esphome::ld2410s {
+
+template<typename... Ts> class SuggestThresholdsAction : public Action<Ts...>, public Parented<LD2410SComponent> {
+ public:
+  void play(const Ts &...x) override {
+    this->parent_->suggest_thresholds(this->trigger_margin_.value(x...), this->hold_margin_.value(x...));
+  }
+
+ protected:
+  TEMPLATABLE_VALUE(uint8_t, trigger_margin)
+  TEMPLATABLE_VALUE(uint8_t, hold_margin)
+};
+
+template<typename... Ts>
+class ApplySuggestedThresholdsAction : public Action<Ts...>, public Parented<LD2410SComponent> {
+ public:
+  void play(const Ts &...x) override {
+    this->parent_->apply_suggested_thresholds(this->trigger_margin_.value(x...), this->hold_margin_.value(x...));
+  }
+
+ protected:
+  TEMPLATABLE_VALUE(uint8_t, trigger_margin)
+  TEMPLATABLE_VALUE(uint8_t, hold_margin)
+};
+
+template<typename... Ts> class ResetNoiseStatsAction : public Action<Ts...>, public Parented<LD2410SComponent> {
+ public:
+  void play(const Ts &...x) override { this->parent_->reset_noise_stats(); }
+};
+
+template<typename... Ts> class DumpHistoryAction : public Action<Ts...>, public Parented<LD2410SComponent> {
+ public:
+  void play(const Ts &...x) override { this->parent_->dump_history(); }
+};
+
+}  // namespace esphome::ld2410s
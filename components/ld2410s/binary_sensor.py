@@ -14,6 +14,45 @@ from . import CONF_LD2410S_ID, LD2410SComponent
 DEPENDENCIES = ["ld2410s"]
 
 CONF_CAL_RUNNING = "cal_running"
+CONF_ENTER_DELAY = "enter_delay"
+CONF_EXIT_DELAY = "exit_delay"
+CONF_HYSTERESIS = "hysteresis"
+CONF_MAX_DISTANCE = "max_distance"
+CONF_MIN_DISTANCE = "min_distance"
+CONF_ZONES = "zones"
+
+
+def validate_zone(config):
+    if config[CONF_MIN_DISTANCE] >= config[CONF_MAX_DISTANCE]:
+        raise cv.Invalid(f"{CONF_MIN_DISTANCE} must be less than {CONF_MAX_DISTANCE}")
+    return config
+
+
+ZONE_SCHEMA = cv.All(
+    binary_sensor.binary_sensor_schema(
+        device_class=DEVICE_CLASS_OCCUPANCY,
+        icon=ICON_ACCOUNT,
+    ).extend(
+        {
+            cv.Required(CONF_MIN_DISTANCE): cv.All(
+                cv.distance, cv.Range(min=0.0, max=16.0)
+            ),
+            cv.Required(CONF_MAX_DISTANCE): cv.All(
+                cv.distance, cv.Range(min=0.0, max=16.0)
+            ),
+            cv.Optional(CONF_HYSTERESIS, default="0.1m"): cv.All(
+                cv.distance, cv.Range(min=0.0, max=2.0)
+            ),
+            cv.Optional(
+                CONF_ENTER_DELAY, default="0s"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(
+                CONF_EXIT_DELAY, default="0s"
+            ): cv.positive_time_period_milliseconds,
+        }
+    ),
+    validate_zone,
+)
 
 CONFIG_SCHEMA = {
     cv.GenerateID(CONF_ID): cv.declare_id(cg.EntityBase),
@@ -27,6 +66,7 @@ CONFIG_SCHEMA = {
         filters=[{"settle": cv.TimePeriod(milliseconds=1000)}],
         icon=ICON_ACCOUNT,
     ),
+    cv.Optional(CONF_ZONES): cv.ensure_list(ZONE_SCHEMA),
 }
 
 
@@ -38,3 +78,15 @@ async def to_code(config):
     if cal_running_config := config.get(CONF_CAL_RUNNING):
         sens = await binary_sensor.new_binary_sensor(cal_running_config)
         cg.add(ld2410s_component.set_cal_running_binary_sensor(sens))
+    for zone_config in config.get(CONF_ZONES, []):
+        sens = await binary_sensor.new_binary_sensor(zone_config)
+        cg.add(
+            ld2410s_component.add_zone(
+                sens,
+                round(zone_config[CONF_MIN_DISTANCE] * 100),
+                round(zone_config[CONF_MAX_DISTANCE] * 100),
+                round(zone_config[CONF_HYSTERESIS] * 100),
+                zone_config[CONF_ENTER_DELAY],
+                zone_config[CONF_EXIT_DELAY],
+            )
+        )
@@ -13,6 +13,9 @@ static const uint32_t STD_DATA_FRAME_HEADER = 0xF1F2F3F4;
 static const uint32_t STD_DATA_FRAME_FOOTER = 0xF5F6F7F8;
 static const uint32_t CMD_FRAME_HEADER = 0xFAFBFCFD;
 static const uint32_t CMD_FRAME_FOOTER = 0x01020304;
+// first byte on the wire of the little endian headers above
+static const uint8_t STD_DATA_FRAME_HEADER_START = STD_DATA_FRAME_HEADER & 0xFF;
+static const uint8_t CMD_FRAME_HEADER_START = CMD_FRAME_HEADER & 0xFF;
 
 static const uint16_t CONFIG_MODE_START_CMD = 0x00FF;
 static const uint16_t CONFIG_MODE_START_VALUE = 0x0001;
@@ -54,6 +57,24 @@ static const uint32_t CFG_GATE_SNRS_WRITE_DATA[] = {
     25, 25, 25, 25, 25, 22, 22, 22   // Distance Gate 8~15 Holding Thresholds range 5~63 dB
 };
 
+// smallest raw gate energy reaching each whole dB, floor(10 * log10(energy)) without floating point math
+static const uint32_t GATE_ENERGY_DB_THRESHOLDS[] = {
+    1, 2, 2, 2, 3, 4, 4, 6,  // 0~7 dB
+    7, 8, 10, 13, 16, 20, 26, 32,  // 8~15 dB
+    40, 51, 64, 80, 100, 126, 159, 200,  // 16~23 dB
+    252, 317, 399, 502, 631, 795, 1000, 1259,  // 24~31 dB
+    1585, 1996, 2512, 3163, 3982, 5012, 6310, 7944,  // 32~39 dB
+    10000, 12590, 15849, 19953, 25119, 31623, 39811, 50119,  // 40~47 dB
+    63096, 79433, 100000, 125893, 158490, 199527, 251189, 316228,  // 48~55 dB
+    398108, 501188, 630958, 794329, 1000000, 1258926, 1584894, 1995263,  // 56~63 dB
+    2511887, 3162278, 3981072, 5011873, 6309574, 7943283, 10000000, 12589255,  // 64~71 dB
+    15848932, 19952624, 25118865, 31622777, 39810718, 50118724, 63095735, 79432824,  // 72~79 dB
+    100000000, 125892542, 158489320, 199526232, 251188644, 316227767, 398107171, 501187234,  // 80~87 dB
+    630957345, 794328235, 1000000000, 1258925412, 1584893193, 1995262315, 2511886432, 3162277661,  // 88~95 dB
+    3981071706,  // 96 dB
+};
+static const uint8_t GATE_ENERGY_UNKNOWN = 0xFF;  // forces the next gate energy to be published
+
 // ToDo
 // static const uint16_t SN_READ_CMD = 0x0011;
 // static const uint16_t SN_WRITE_CMD = 0x0010;
@@ -61,16 +82,28 @@ static const uint32_t CFG_GATE_SNRS_WRITE_DATA[] = {
 #pragma endregion
 
 #pragma region Defines
+#ifdef USE_BINARY_SENSOR
 #define SAFE_PUBLISH_BINARY_SENSOR(sensor, value) \
   if (sensor != nullptr) \
     if (sensor->state != static_cast<bool>(value)) \
       sensor->publish_state(static_cast<bool>(value));
+#else
+#define SAFE_PUBLISH_BINARY_SENSOR(sensor, value)
+#endif
 #define SAFE_PUBLISH_NUMBER(sensor, value) \
   if (sensor != nullptr) \
     if (sensor->state != static_cast<float>(value)) \
       sensor->publish_state(static_cast<float>(value));
 #pragma endregion
 
+// converts raw gate energy to whole dB, 0 for no energy
+static inline uint8_t energy_to_db(uint32_t energy) {
+  const uint32_t *begin = std::begin(GATE_ENERGY_DB_THRESHOLDS);
+  const uint32_t *end = std::end(GATE_ENERGY_DB_THRESHOLDS);
+  auto db = std::upper_bound(begin, end, energy) - begin;
+  return db > 0 ? db - 1 : 0;
+}
+
 // Helper function to format firmware version with stack allocation
 // Buffer must be exactly 20 bytes (format: "vx.x.x" fits in 20 {19 + null terminator})
 static inline void format_version_str(const uint16_t *version, std::span<char, 20> buffer) {
@@ -83,21 +116,61 @@ void LD2410SComponent::setup() {
   ESP_LOGD(TAG, "Setup");
   SAFE_PUBLISH_SENSOR(this->target_distance_sensor_, this->target_distance_);
   SAFE_PUBLISH_SENSOR(this->cal_progress_sensor_, this->cal_progress_);
+#ifdef USE_BINARY_SENSOR
   if (this->has_target_binary_sensor_ != nullptr) {
     this->has_target_binary_sensor_->publish_state(this->has_target_);
   }
   if (this->cal_running_binary_sensor_ != nullptr) {
     this->cal_running_binary_sensor_->publish_state(this->cal_running_);
   }
+  for (auto &zone : this->zones_) {
+    zone.sensor->publish_initial_state(false);
+  }
+#endif
+  std::fill(std::begin(this->gate_energy_), std::end(this->gate_energy_), GATE_ENERGY_UNKNOWN);
+  if (this->noise_stats_enabled_) {
+    this->noise_stats_ = std::make_unique<GateNoiseStatsT[]>(TOTAL_GATES);
+  }
+  if (this->history_size_ > 0) {
+    this->history_ = std::make_unique<HistoryRecordT[]>(this->history_size_);
+  }
   this->init_done_ = false;
   this->minimal_output_ = true;
+  // the restored config is published right away, the radar config is still read to verify it
+  if (this->restore_config_ && this->restore_config_shadow_()) {
+    this->verify_reads_ = 4;  // firmware, parameters, thresholds and SNRs
+  }
   this->read_all_();
+#ifdef USE_SENSOR
+  if (this->gate_energy_window_ > 0) {
+    this->set_interval("energy", this->gate_energy_window_, [this]() { this->publish_gate_energy_window_(); });
+  }
+#endif
+  if (this->rx_poll_interval_ > 0) {
+    this->set_interval("rx poll", this->rx_poll_interval_, [this]() {
+      if (this->available() > 0) {
+        this->enable_loop();
+      }
+    });
+  }
+  this->log_stats_ = this->stats_interval_ > 0;
+  if (this->link_stats_ && this->stats_interval_ == 0) {
+    this->stats_interval_ = LINK_STATS_INTERVAL;
+  }
+  if (this->stats_interval_ > 0) {
+    this->stats_start_ = millis();
+    this->set_interval("stats", this->stats_interval_, [this]() { this->update_stats_(); });
+  }
 }
 
 void LD2410SComponent::loop() {
   if (!this->receive_()) {
     if (!this->pause_tx_) {
       this->send_();
+      if (this->rx_poll_interval_ > 0 && this->init_done_ && this->tx_schedule_.is_idle()) {
+        // nothing to receive or send, the rx poll wakes the loop again
+        this->disable_loop();
+      }
     }
   }
   this->loop_count_++;
@@ -113,11 +186,27 @@ void LD2410SComponent::dump_config() {
                 "LD2410S:\n"
                 "  Firmware version: %s",
                 version_s);
+  ESP_LOGCONFIG(TAG, "  Restore config: %s", YESNO(this->restore_config_));
+  ESP_LOGCONFIG(TAG, "  Noise statistics: %s", YESNO(this->noise_stats_enabled_));
+  if (this->history_size_ > 0) {
+    ESP_LOGCONFIG(TAG, "  History size: %" PRIu16 " frames", this->history_size_);
+  }
+  if (this->rx_poll_interval_ > 0) {
+    ESP_LOGCONFIG(TAG, "  RX poll interval: %" PRIu32 " ms", this->rx_poll_interval_);
+  }
+  if (this->stats_interval_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Link stats interval: %" PRIu32 " ms", this->stats_interval_);
+  }
 
 #ifdef USE_BINARY_SENSOR
   ESP_LOGCONFIG(TAG, "Binary Sensors:");
   LOG_BINARY_SENSOR("  ", "Has Target", this->has_target_binary_sensor_);
   LOG_BINARY_SENSOR("  ", "Cal Running", this->cal_running_binary_sensor_);
+  for (auto &zone : this->zones_) {
+    LOG_BINARY_SENSOR("  ", "Zone", zone.sensor);
+    ESP_LOGCONFIG(TAG, "    Distance: %" PRIu16 "~%" PRIu16 " cm, hysteresis: %" PRIu16 " cm", zone.min_distance,
+                  zone.max_distance, zone.hysteresis);
+  }
 #endif
 #ifdef USE_SENSOR
   ESP_LOGCONFIG(TAG, "Sensors:");
@@ -125,7 +214,18 @@ void LD2410SComponent::dump_config() {
   for (auto &s : this->gate_energy_sensor_) {
     LOG_SENSOR_WITH_DEDUP_SAFE("  ", "Gate Energy", s);
   }
+  if (this->gate_energy_window_ > 0) {
+    static const char *const AGGREGATIONS[] = {"last", "max", "mean"};
+    ESP_LOGCONFIG(TAG, "  Gate Energy Window: %" PRIu32 " ms, aggregation: %s", this->gate_energy_window_,
+                  AGGREGATIONS[static_cast<uint8_t>(this->gate_energy_aggregation_)]);
+  }
   LOG_SENSOR_WITH_DEDUP_SAFE("  ", "Target Distance", this->target_distance_sensor_);
+  LOG_SENSOR_WITH_DEDUP_SAFE("  ", "Frame Rate", this->frame_rate_sensor_);
+  LOG_SENSOR_WITH_DEDUP_SAFE("  ", "Resync Bytes", this->resync_bytes_sensor_);
+  LOG_SENSOR_WITH_DEDUP_SAFE("  ", "Buffer Overflows", this->buffer_overflows_sensor_);
+  LOG_SENSOR_WITH_DEDUP_SAFE("  ", "Command Retries", this->command_retries_sensor_);
+  LOG_SENSOR_WITH_DEDUP_SAFE("  ", "Command Restarts", this->command_restarts_sensor_);
+  LOG_SENSOR_WITH_DEDUP_SAFE("  ", "ACK Latency", this->ack_latency_sensor_);
 #endif
 #ifdef USE_TEXT_SENSOR
   ESP_LOGCONFIG(TAG, "Text Sensors:");
@@ -161,7 +261,7 @@ void LD2410SComponent::cal_start() {
   this->cal_running_ = true;
   SAFE_PUBLISH_SENSOR(this->cal_progress_sensor_, this->cal_progress_);
   SAFE_PUBLISH_BINARY_SENSOR(this->cal_running_binary_sensor_, this->cal_running_);
-  this->tx_schedule_.append(CALIBRATION_CMD);
+  this->schedule_command_(CALIBRATION_CMD);
 }
 void LD2410SComponent::factory_reset() {
   ESP_LOGI(TAG, "factory_reset");
@@ -185,79 +285,91 @@ void LD2410SComponent::factory_reset() {
   }
 
   // send defaults to radar
-  this->tx_schedule_.append(OUTPUT_MODE_SWITCH_CMD);
+  this->schedule_command_(OUTPUT_MODE_SWITCH_CMD);
 
-  this->tx_schedule_.append(CFG_PARAMS_WRITE_CMD);
-  this->tx_schedule_.append(CFG_GATE_THRESHOLDS_WRITE_CMD);
-  this->tx_schedule_.append(CFG_GATE_SNRS_WRITE_CMD);
+  this->schedule_command_(CFG_PARAMS_WRITE_CMD);
+  this->schedule_command_(CFG_GATE_THRESHOLDS_WRITE_CMD);
+  this->schedule_command_(CFG_GATE_SNRS_WRITE_CMD);
 
-  this->tx_schedule_.append(CFG_PARAMS_READ_CMD);
-  this->tx_schedule_.append(CFG_GATE_THRESHOLDS_READ_CMD);
-  this->tx_schedule_.append(CFG_GATE_SNRS_READ_CMD);
+  this->schedule_command_(CFG_PARAMS_READ_CMD);
+  this->schedule_command_(CFG_GATE_THRESHOLDS_READ_CMD);
+  this->schedule_command_(CFG_GATE_SNRS_READ_CMD);
 }
 // number
 void LD2410SComponent::set_no_delay(float delay) {
   this->delay_ = delay;
-  this->tx_schedule_.append(CFG_PARAMS_WRITE_CMD, CFG_NO_DELAY_VALUE);
+  this->schedule_command_(CFG_PARAMS_WRITE_CMD, CFG_NO_DELAY_VALUE);
 }
 void LD2410SComponent::set_distance_reporting_freq(float distance_reporting_freq) {
   this->distance_reporting_freq_ = distance_reporting_freq * 10;
-  this->tx_schedule_.append(CFG_PARAMS_WRITE_CMD, CFG_DISTANCE_FREQ_VALUE);
+  this->schedule_command_(CFG_PARAMS_WRITE_CMD, CFG_DISTANCE_FREQ_VALUE);
 }
 void LD2410SComponent::set_max_detect_gate(float max_detect_gate) {
   this->max_detect_gate_ = max_detect_gate;
-  this->tx_schedule_.append(CFG_PARAMS_WRITE_CMD, CFG_MAX_DETECTION_VALUE);
+  this->schedule_command_(CFG_PARAMS_WRITE_CMD, CFG_MAX_DETECTION_VALUE);
 }
 void LD2410SComponent::set_min_detect_gate(float min_detect_gate) {
   this->min_detect_gate_ = min_detect_gate;
-  this->tx_schedule_.append(CFG_PARAMS_WRITE_CMD, CFG_MIN_DETECTION_VALUE);
+  this->schedule_command_(CFG_PARAMS_WRITE_CMD, CFG_MIN_DETECTION_VALUE);
 }
 void LD2410SComponent::set_status_reporting_freq(float status_reporting_freq) {
   this->status_reporting_freq_ = status_reporting_freq * 10;
-  this->tx_schedule_.append(CFG_PARAMS_WRITE_CMD, CFG_STATUS_FREQ_VALUE);
+  this->schedule_command_(CFG_PARAMS_WRITE_CMD, CFG_STATUS_FREQ_VALUE);
 }
+// gates 0~7 live in the thresholds table, gates 8~15 in the snrs table, each with triggers first then holds
 void LD2410SComponent::set_gate_hold_threshold(uint8_t gate, float hold_threshold) {
   this->gate_hold_threshold_[gate] = hold_threshold;
-  this->tx_schedule_.append(CFG_GATE_THRESHOLDS_WRITE_CMD, gate);
+  if (gate < 8) {
+    this->schedule_command_(CFG_GATE_THRESHOLDS_WRITE_CMD, gate + 8);
+  } else {
+    this->schedule_command_(CFG_GATE_SNRS_WRITE_CMD, gate);
+  }
 }
 void LD2410SComponent::set_gate_trig_threshold(uint8_t gate, float trigger_threshold) {
   this->gate_trig_threshold_[gate] = trigger_threshold;
-  this->tx_schedule_.append(CFG_GATE_THRESHOLDS_WRITE_CMD, gate);
+  if (gate < 8) {
+    this->schedule_command_(CFG_GATE_THRESHOLDS_WRITE_CMD, gate);
+  } else {
+    this->schedule_command_(CFG_GATE_SNRS_WRITE_CMD, gate - 8);
+  }
 }
 // select
 void LD2410SComponent::set_response_speed(size_t index) {
   this->resp_speed_ = index == 1 ? 10 : 5;
-  this->tx_schedule_.append(CFG_PARAMS_WRITE_CMD, CFG_RESPONSE_SPEED_VALUE);
+  this->schedule_command_(CFG_PARAMS_WRITE_CMD, CFG_RESPONSE_SPEED_VALUE);
 }
 // switch
 void LD2410SComponent::set_minimal_output(bool state) {
   this->minimal_output_ = state;
-  this->tx_schedule_.append(OUTPUT_MODE_SWITCH_CMD);
+  this->schedule_command_(OUTPUT_MODE_SWITCH_CMD);
 #ifdef USE_SENSOR
   if (state) {
     for (uint8_t gate = 0; gate < TOTAL_GATES; gate++) {
       SAFE_PUBLISH_SENSOR_UNKNOWN(this->gate_energy_sensor_[gate]);
+      this->gate_energy_[gate] = GATE_ENERGY_UNKNOWN;
     }
+    this->reset_gate_energy_window_();
   }
 #endif
 }
 void LD2410SComponent::read_all_() {
-  this->tx_schedule_.append(OUTPUT_MODE_SWITCH_CMD);
-  this->tx_schedule_.append(CFG_FW_READ_CMD);
-  this->tx_schedule_.append(CFG_PARAMS_READ_CMD);
-  this->tx_schedule_.append(CFG_GATE_THRESHOLDS_READ_CMD);
-  this->tx_schedule_.append(CFG_GATE_SNRS_READ_CMD);
+  this->schedule_command_(OUTPUT_MODE_SWITCH_CMD);
+  this->schedule_command_(CFG_FW_READ_CMD);
+  this->schedule_command_(CFG_PARAMS_READ_CMD);
+  this->schedule_command_(CFG_GATE_THRESHOLDS_READ_CMD);
+  this->schedule_command_(CFG_GATE_SNRS_READ_CMD);
 }
 // prepares scheduled frames for sending
 // executes actual data sending
 void LD2410SComponent::send_() {
-  switch (this->tx_schedule_.check_state(this->loop_count_)) {
+  switch (this->tx_schedule_.check_state(millis())) {
     case TxCmdState::SCHEDULED:
-      this->build_cmd_frame_(this->tx_schedule_.get_command(), this->tx_schedule_.get_sub_command());
       this->tx_schedule_.confirm_ready_to_send();
       break;
 
     case TxCmdState::SEND:
+      // the frame buffer is shared by all instances, build and write in one go
+      this->build_cmd_frame_(this->tx_schedule_.get_command(), this->tx_schedule_.get_sub_command());
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
       char hex_buf[format_hex_pretty_size(RX_TX_BUFFER_SIZE)];
       ESP_LOGVV(TAG, ">   [loop:%" PRIu32 "] cmd:%04" PRIX16 " > %s", this->loop_count_,
@@ -267,8 +379,7 @@ void LD2410SComponent::send_() {
       this->write_array(this->tx_frame_, this->tx_frame_size_);
       this->flush();
 
-      this->tx_schedule_.confirm_sent();
-      this->sending_pause_();
+      this->tx_schedule_.confirm_sent(millis());
 
       break;
 
@@ -363,43 +474,21 @@ void LD2410SComponent::build_cmd_frame_(uint16_t command, uint16_t sub_command)
         ESP_LOGD(TAG, "CFG_PARAMS_WRITE_CMD Error, bad new_config");
         return;
       } else {
-        switch (sub_command) {
-          case CFG_MAX_DETECTION_VALUE:
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, sub_command, &this->max_detect_gate_);
-            break;
-
-          case CFG_MIN_DETECTION_VALUE:
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, sub_command, &this->min_detect_gate_);
-            break;
-
-          case CFG_NO_DELAY_VALUE:
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, sub_command, &this->delay_);
-            break;
-
-          case CFG_STATUS_FREQ_VALUE:
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, sub_command, &this->status_reporting_freq_);
-            break;
-
-          case CFG_DISTANCE_FREQ_VALUE:
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, sub_command, &this->distance_reporting_freq_);
-            break;
-
-          case CFG_RESPONSE_SPEED_VALUE:
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, sub_command, &this->resp_speed_);
-            break;
-
-          default:
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, CFG_MAX_DETECTION_VALUE,
-                                  &this->max_detect_gate_);
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, CFG_MIN_DETECTION_VALUE,
-                                  &this->min_detect_gate_);
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, CFG_NO_DELAY_VALUE, &this->delay_);
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, CFG_STATUS_FREQ_VALUE,
-                                  &this->status_reporting_freq_);
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, CFG_DISTANCE_FREQ_VALUE,
-                                  &this->distance_reporting_freq_);
-            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, CFG_RESPONSE_SPEED_VALUE, &this->resp_speed_);
-            break;
+        // single parameter id or PARAMS_MASK_SUB_CMD with the parameter id bits set, NO_SUB_CMD writes all
+        const std::pair<uint16_t, const uint32_t *> params[] = {
+            {CFG_MAX_DETECTION_VALUE, &this->max_detect_gate_},
+            {CFG_MIN_DETECTION_VALUE, &this->min_detect_gate_},
+            {CFG_NO_DELAY_VALUE, &this->delay_},
+            {CFG_STATUS_FREQ_VALUE, &this->status_reporting_freq_},
+            {CFG_DISTANCE_FREQ_VALUE, &this->distance_reporting_freq_},
+            {CFG_RESPONSE_SPEED_VALUE, &this->resp_speed_},
+        };
+        for (const auto &param : params) {
+          bool selected = (sub_command & PARAMS_MASK_SUB_CMD) != 0 ? (sub_command & (1 << param.first)) != 0
+                                                                   : sub_command == param.first;
+          if (selected) {
+            append_seq_data_value(this->tx_frame_, this->tx_frame_size_, param.first, param.second);
+          }
         }
         break;
       }
@@ -443,31 +532,85 @@ void LD2410SComponent::build_cmd_frame_(uint16_t command, uint16_t sub_command)
   append_seq_data(this->tx_frame_, this->tx_frame_size_, &CMD_FRAME_FOOTER);
 }
 
-void LD2410SComponent::sending_pause_() {
+// appends command to the schedule and makes sure the loop runs to send it
+void LD2410SComponent::schedule_command_(uint16_t command, uint16_t sub_command) {
+  this->tx_schedule_.append(command, sub_command);
+  if (this->rx_poll_interval_ > 0) {
+    this->enable_loop();
+  }
+}
+void LD2410SComponent::sending_pause_(uint32_t pause) {
   this->pause_tx_ = true;
-  this->set_timeout("Pausing Sending", TX_PAUSE_TIMEOUT, [this]() {
-    ESP_LOGVV(TAG, "Proceeding after tx pause of %" PRIu32 " ms", TX_PAUSE_TIMEOUT);
+  this->set_timeout("Pausing Sending", pause, [this, pause]() {
+    ESP_LOGVV(TAG, "Proceeding after tx pause of %" PRIu32 " ms", pause);
     this->pause_tx_ = false;
   });
 }
 
-// receives frames and starts processing
+// drains the uart in blocks and processes all complete frames
 bool LD2410SComponent::receive_() {
-  uint8_t rx;
-  int rx_bytes_count = 0;
-
-  while (this->available() && rx_bytes_count < RX_MAX_BYTES_PER_LOOP) {
-    if (!this->read_byte(&rx))
+  size_t rx_bytes_count = 0;
+  size_t available = this->available();
+  if (available == 0)
+    return false;
+  uint32_t start_us = this->stats_interval_ > 0 ? micros() : 0;
+
+  while (available > 0 && rx_bytes_count < RX_MAX_BYTES_PER_LOOP) {
+    size_t len = std::min(available, RX_MAX_BYTES_PER_LOOP - rx_bytes_count);
+    len = std::min(len, this->rx_.prepare_write());
+    if (len == 0 || !this->read_array(this->rx_.write_ptr(), len))
       break;
-    rx_bytes_count++;
+    this->rx_.commit_write(len);
+    rx_bytes_count += len;
+    available -= len;
 
-    if (this->rx_.receive_byte(this->loop_count_, rx) == RxEvaluationResult::OK) {
+    while (this->rx_.next_frame(this->loop_count_)) {
       this->parse_();
-      this->rx_.reset();
     }
+    if (available == 0) {
+      available = this->available();
+    }
+  }
+  if (this->stats_interval_ > 0) {
+    this->rx_time_us_ += micros() - start_us;
   }
   return rx_bytes_count > 0;
 }
+// logs and publishes the link statistics, then starts a new window
+void LD2410SComponent::update_stats_() {
+  const RxStatsT &stats = this->rx_.stats();
+  const TxStatsT &tx_stats = this->tx_schedule_.stats();
+  uint32_t now = millis();
+  uint32_t elapsed = std::max<uint32_t>(now - this->stats_start_, 1);
+  uint32_t frames = stats.short_frames + stats.std_frames + stats.cmd_frames;
+  uint32_t centi_fps = static_cast<uint32_t>(static_cast<uint64_t>(frames) * 100000 / elapsed);
+
+  if (this->log_stats_) {
+    uint32_t ns_per_byte =
+        stats.bytes > 0 ? static_cast<uint32_t>(static_cast<uint64_t>(this->rx_time_us_) * 1000 / stats.bytes) : 0;
+    ESP_LOGI(TAG,
+             "Link stats over %" PRIu32 " ms:\n"
+             "  Frames: %" PRIu32 " (%" PRIu32 ".%02" PRIu32 "/s) short:%" PRIu32 " std:%" PRIu32 " cmd:%" PRIu32 "\n"
+             "  Bytes: %" PRIu32 " (%" PRIu32 " ns/byte), dropped on resync: %" PRIu32 ", overflows: %" PRIu32 "\n"
+             "  Commands: retries:%" PRIu32 ", restarts:%" PRIu32 ", failures:%" PRIu32 ", ack latency:%" PRIu32 " ms",
+             elapsed, frames, centi_fps / 100, centi_fps % 100, stats.short_frames, stats.std_frames,
+             stats.cmd_frames, stats.bytes, ns_per_byte, stats.discarded, stats.overflows, tx_stats.retries,
+             tx_stats.restarts, tx_stats.failures, this->tx_schedule_.get_ack_latency());
+  }
+#ifdef USE_SENSOR
+  SAFE_PUBLISH_SENSOR(this->frame_rate_sensor_, centi_fps / 100.0f);
+  SAFE_PUBLISH_SENSOR(this->resync_bytes_sensor_, stats.discarded);
+  SAFE_PUBLISH_SENSOR(this->buffer_overflows_sensor_, stats.overflows);
+  SAFE_PUBLISH_SENSOR(this->command_retries_sensor_, tx_stats.retries);
+  SAFE_PUBLISH_SENSOR(this->command_restarts_sensor_, tx_stats.restarts);
+  SAFE_PUBLISH_SENSOR(this->ack_latency_sensor_, this->tx_schedule_.get_ack_latency());
+#endif
+
+  this->rx_.reset_stats();
+  this->tx_schedule_.reset_stats();
+  this->rx_time_us_ = 0;
+  this->stats_start_ = now;
+}
 // starts received frame decoding, and handling received data
 void LD2410SComponent::parse_() {
   switch (this->rx_.frame_type()) {
@@ -507,8 +650,85 @@ void LD2410SComponent::parse_short_data_frame_() {
   if (!this->has_target_)
     this->target_distance_ = 0;
 
-  SAFE_PUBLISH_SENSOR(this->target_distance_sensor_, this->target_distance_);
+  this->publish_target_distance_();
   SAFE_PUBLISH_BINARY_SENSOR(this->has_target_binary_sensor_, this->has_target_);
+#ifdef USE_BINARY_SENSOR
+  this->update_zones_();
+#endif
+}
+#ifdef USE_SENSOR
+// publishes the aggregated gate energies of the finished window
+void LD2410SComponent::publish_gate_energy_window_() {
+  if (this->gate_energy_count_ == 0) {
+    return;  // no energy values received during this window
+  }
+  for (uint8_t gate = 0; gate < TOTAL_GATES; gate++) {
+    uint8_t db;
+    switch (this->gate_energy_aggregation_) {
+      case GateEnergyAggregation::MAX:
+        db = this->gate_energy_max_[gate];
+        break;
+      case GateEnergyAggregation::MEAN:
+        db = (this->gate_energy_sum_[gate] + this->gate_energy_count_ / 2) / this->gate_energy_count_;
+        break;
+      case GateEnergyAggregation::LAST:
+      default:
+        db = this->gate_energy_[gate];
+        break;
+    }
+    SAFE_PUBLISH_SENSOR(this->gate_energy_sensor_[gate], db);
+  }
+  this->reset_gate_energy_window_();
+}
+void LD2410SComponent::reset_gate_energy_window_() {
+  std::fill(std::begin(this->gate_energy_sum_), std::end(this->gate_energy_sum_), 0);
+  std::fill(std::begin(this->gate_energy_max_), std::end(this->gate_energy_max_), 0);
+  this->gate_energy_count_ = 0;
+}
+#endif
+#ifdef USE_BINARY_SENSOR
+// evaluates the distance zones against the target of the current frame
+void LD2410SComponent::update_zones_() {
+  uint32_t now = App.get_loop_component_start_time();
+  for (auto &zone : this->zones_) {
+    // an occupied zone is left only when the target moves past the hysteresis
+    int32_t margin = zone.occupied ? zone.hysteresis : 0;
+    int32_t distance = this->target_distance_;
+    bool inside = this->has_target_ && distance >= zone.min_distance - margin && distance <= zone.max_distance + margin;
+
+    if (inside == zone.occupied) {
+      zone.pending = false;
+      continue;
+    }
+    if (!zone.pending) {
+      zone.pending = true;
+      zone.pending_since = now;
+    }
+    if (now - zone.pending_since >= (inside ? zone.enter_delay : zone.exit_delay)) {
+      zone.pending = false;
+      zone.occupied = inside;
+      zone.sensor->publish_state(inside);
+    }
+  }
+}
+#endif
+// publishes target distance through the optional filter, losing the target always publishes right away
+void LD2410SComponent::publish_target_distance_() {
+#ifdef USE_SENSOR
+  if (this->distance_filter_.get_type() == DistanceFilterType::NONE) {
+    SAFE_PUBLISH_SENSOR(this->target_distance_sensor_, this->target_distance_);
+    return;
+  }
+  if (!this->has_target_) {
+    this->distance_filter_.reset();
+    SAFE_PUBLISH_SENSOR(this->target_distance_sensor_, this->target_distance_);
+    return;
+  }
+  uint16_t filtered;
+  if (this->distance_filter_.update(this->target_distance_, filtered)) {
+    SAFE_PUBLISH_SENSOR(this->target_distance_sensor_, filtered);
+  }
+#endif
 }
 void LD2410SComponent::parse_data_frame_() {
   if (this->rx_.payload_size() < 1) {
@@ -535,16 +755,21 @@ void LD2410SComponent::parse_data_frame_() {
       if (!this->has_target_) {
         this->target_distance_ = 0;
       }
-      SAFE_PUBLISH_SENSOR(this->target_distance_sensor_, this->target_distance_);
+      this->publish_target_distance_();
       SAFE_PUBLISH_BINARY_SENSOR(this->has_target_binary_sensor_, this->has_target_);
+#ifdef USE_BINARY_SENSOR
+      this->update_zones_();
+#endif
 
       if (this->rx_.payload_size() < 7) {
         // no energy values
+        this->record_history_(false);
         ESP_LOGV(TAG, "Std Data Frame Parsed Has Target=%s, Target Distance=%" PRIu16 "cm",
                  TRUEFALSE(this->has_target_), this->target_distance_);
       } else {
         // energy values included
         this->parse_data_energy_values_read_(&this->rx_.payload_data()[6]);
+        this->record_history_(true);
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
         char energy_s[65];
         snprintf(energy_s, 65,
@@ -625,7 +850,9 @@ void LD2410SComponent::parse_cmd_frame_() {
 #endif
   }
 
-  this->tx_schedule_.verify_response(command_word, this->loop_count_);
+  if (this->tx_schedule_.verify_response(command_word, millis())) {
+    this->sending_pause_(this->tx_schedule_.get_pause());
+  }
 
   uint8_t *data = &data_start[read_position];
 
@@ -650,6 +877,7 @@ void LD2410SComponent::parse_cmd_frame_() {
 
     case CFG_PARAMS_WRITE_CMD | CMD_CONFIRMATION:
       ESP_LOGI(TAG, "Config written");
+      this->schedule_config_save_();
       break;
 
     case OUTPUT_MODE_SWITCH_CMD | CMD_CONFIRMATION:
@@ -658,10 +886,12 @@ void LD2410SComponent::parse_cmd_frame_() {
 
     case CFG_GATE_THRESHOLDS_WRITE_CMD | CMD_CONFIRMATION:
       ESP_LOGI(TAG, "Gate Threshold written");
+      this->schedule_config_save_();
       break;
 
     case CFG_GATE_SNRS_WRITE_CMD | CMD_CONFIRMATION:
       ESP_LOGI(TAG, "Gate SNR written");
+      this->schedule_config_save_();
       break;
 
       // Read command acknowledgements
@@ -670,24 +900,32 @@ void LD2410SComponent::parse_cmd_frame_() {
       if (this->rx_.payload_size() < 28)
         break;
       this->parse_ack_config_read_(data);
+      this->verify_config_shadow_();
+      this->schedule_config_save_();
       break;
 
     case CFG_FW_READ_CMD | CMD_CONFIRMATION:
       if (this->rx_.payload_size() < 14)
         break;
       this->parse_ack_fw_read_(data);
+      this->verify_config_shadow_();
+      this->schedule_config_save_();
       break;
 
     case CFG_GATE_THRESHOLDS_READ_CMD | CMD_CONFIRMATION:
       if (this->rx_.payload_size() < 68)
         break;
       this->parse_ack_thresholds_read_(data);
+      this->verify_config_shadow_();
+      this->schedule_config_save_();
       break;
 
     case CFG_GATE_SNRS_READ_CMD | CMD_CONFIRMATION:
       if (this->rx_.payload_size() < 68)
         break;
       this->parse_ack_snrs_read_(data);
+      this->verify_config_shadow_();
+      this->schedule_config_save_();
       break;
 
     default:
@@ -697,23 +935,41 @@ void LD2410SComponent::parse_cmd_frame_() {
 }
 
 void LD2410SComponent::read_all_thresholds_() {
-  this->tx_schedule_.append(CFG_GATE_THRESHOLDS_READ_CMD);
-  this->tx_schedule_.append(CFG_GATE_SNRS_READ_CMD);
+  this->schedule_command_(CFG_GATE_THRESHOLDS_READ_CMD);
+  this->schedule_command_(CFG_GATE_SNRS_READ_CMD);
 }
 
 void LD2410SComponent::parse_data_energy_values_read_(uint8_t *data) {
-#ifdef USE_SENSOR
   uint16_t read_position = 0;
+  uint16_t changed_gates = 0;
   for (uint8_t gate = 0; gate < TOTAL_GATES; gate++) {
     uint32_t val = 0;
     read_seq_data(data, read_position, &val);
 
-    uint32_t db = 0;
-    if (val > 0) {
-      db = 10 * log10(val);
+    uint8_t db = energy_to_db(val);
+    if (db != this->gate_energy_[gate]) {
+      this->gate_energy_[gate] = db;
+      changed_gates |= 1 << gate;
     }
-    this->gate_energy_[gate] = db;
-
+    if (this->noise_stats_ != nullptr && !this->has_target_) {
+      this->update_noise_stats_(gate, db);
+    }
+#ifdef USE_SENSOR
+    if (this->gate_energy_window_ > 0) {
+      this->gate_energy_sum_[gate] += db;
+      this->gate_energy_max_[gate] = std::max(this->gate_energy_max_[gate], db);
+    }
+#endif
+  }
+#ifdef USE_SENSOR
+  if (this->gate_energy_window_ > 0) {
+    this->gate_energy_count_++;
+    return;  // published once per window
+  }
+  // only gates whose dB value moved go through the publish path
+  while (changed_gates != 0) {
+    uint8_t gate = __builtin_ctz(changed_gates);
+    changed_gates &= changed_gates - 1;
     SAFE_PUBLISH_SENSOR(this->gate_energy_sensor_[gate], this->gate_energy_[gate]);
   }
 #endif
@@ -760,7 +1016,9 @@ void LD2410SComponent::parse_ack_config_read_(uint8_t *data) {
   } else {
     ESP_LOGV(TAG, "Parsed Response Speed: %s", "Fast");
   }
-
+  this->publish_config_();
+}
+void LD2410SComponent::publish_config_() {
 #ifdef USE_NUMBER
   SAFE_PUBLISH_NUMBER(this->max_detect_gate_number_, static_cast<float>(this->max_detect_gate_));
   SAFE_PUBLISH_NUMBER(this->min_detect_gate_number_, static_cast<float>(this->min_detect_gate_));
@@ -779,6 +1037,9 @@ void LD2410SComponent::parse_ack_fw_read_(const uint8_t *data) {
   read_seq_data(data, read_position, &this->version_[0]);
   read_seq_data(data, read_position, &this->version_[1]);
   read_seq_data(data, read_position, &this->version_[2]);
+  this->publish_fw_version_();
+}
+void LD2410SComponent::publish_fw_version_() {
 #ifdef USE_TEXT_SENSOR
   if (this->fw_version_text_sensor_ != nullptr) {
     char version_s[20];
@@ -823,215 +1084,536 @@ void LD2410SComponent::parse_ack_snrs_read_(uint8_t *data) {
 }
 #pragma endregion
 
-#pragma region LD2410Srx
-
-// appends one byte to rx buffer, and checks if that makes complete frame
-RxEvaluationResult LD2410Srx::receive_byte(uint32_t loop_count, uint8_t byte) {
-  if (this->payload_ready_) {
-    this->reset();
+#pragma region Noise Statistics
+
+// updates running mean/variance (Welford) and the streaming 95th percentile of an idle gate
+void LD2410SComponent::update_noise_stats_(uint8_t gate, uint8_t db) {
+  GateNoiseStatsT &stats = this->noise_stats_[gate];
+  stats.count++;
+  float delta = db - stats.mean;
+  stats.mean += delta / stats.count;
+  stats.m2 += delta * (db - stats.mean);
+
+  // the step up is about 20 times the step down,
+  // the estimate settles where about 1 in 21 samples lie above it (~95th percentile)
+  uint16_t sample = db << 8;
+  if (sample > stats.p95) {
+    stats.p95 = std::min<int>(stats.p95 + NOISE_P95_STEP_UP, sample);
+  } else if (sample < stats.p95) {
+    stats.p95 = std::max<int>(stats.p95 - NOISE_P95_STEP_DOWN, sample);
   }
-
-  this->rcv_buffer_[this->end_pos_] = byte;
-
-  RxEvaluationResult result = this->evaluate_header_(this->end_pos_ + 1);
-  if (result == RxEvaluationResult::OK) {
-    result = this->evaluate_size_(this->end_pos_ + 1);
-    if (result == RxEvaluationResult::OK) {
-      result = this->evaluate_footer_(this->end_pos_ + 1);
+}
+// thresholds just above the gate noise floor, returns false if there are not enough idle samples
+bool LD2410SComponent::suggest_gate_thresholds_(uint8_t gate, uint8_t trigger_margin, uint8_t hold_margin,
+                                                uint32_t &trigger, uint32_t &hold) {
+  const GateNoiseStatsT &stats = this->noise_stats_[gate];
+  if (stats.count < NOISE_STATS_MIN_SAMPLES) {
+    return false;
+  }
+  // the percentile estimate lags behind while converging, never go below mean + 2 sigma
+  float sigma = std::sqrt(stats.m2 / (stats.count - 1));
+  float noise_floor = std::max(stats.p95 / 256.0f, stats.mean + 2 * sigma);
+  uint32_t min = gate < 8 ? 10 : 5;
+  uint32_t max = gate < 8 ? 95 : 63;
+  trigger = std::clamp<uint32_t>(std::ceil(noise_floor) + trigger_margin, min, max);
+  hold = std::clamp<uint32_t>(std::ceil(noise_floor) + hold_margin, min, max);
+  return true;
+}
+void LD2410SComponent::suggest_thresholds(uint8_t trigger_margin, uint8_t hold_margin) {
+  if (this->noise_stats_ == nullptr) {
+    ESP_LOGW(TAG, "Noise statistics are not enabled");
+    return;
+  }
+  for (uint8_t gate = 0; gate < TOTAL_GATES; gate++) {
+    const GateNoiseStatsT &stats = this->noise_stats_[gate];
+    uint32_t trigger, hold;
+    if (!this->suggest_gate_thresholds_(gate, trigger_margin, hold_margin, trigger, hold)) {
+      ESP_LOGI(TAG, "Gate %" PRIu8 ": not enough idle samples (%" PRIu32 ")", gate, stats.count);
+      continue;
     }
+    ESP_LOGI(TAG,
+             "Gate %" PRIu8 ": samples:%" PRIu32 ", mean:%.1f dB, stddev:%.1f dB, p95:%.1f dB => "
+             "trigger:%" PRIu32 " (now %" PRIu32 "), hold:%" PRIu32 " (now %" PRIu32 ")",
+             gate, stats.count, stats.mean, std::sqrt(stats.m2 / (stats.count - 1)), stats.p95 / 256.0f, trigger,
+             this->gate_trig_threshold_[gate], hold, this->gate_hold_threshold_[gate]);
+  }
+}
+void LD2410SComponent::apply_suggested_thresholds(uint8_t trigger_margin, uint8_t hold_margin) {
+  if (this->noise_stats_ == nullptr) {
+    ESP_LOGW(TAG, "Noise statistics are not enabled");
+    return;
+  }
+  uint8_t applied = 0;
+  for (uint8_t gate = 0; gate < TOTAL_GATES; gate++) {
+    uint32_t trigger, hold;
+    if (!this->suggest_gate_thresholds_(gate, trigger_margin, hold_margin, trigger, hold)) {
+      continue;
+    }
+    this->gate_trig_threshold_[gate] = trigger;
+    this->gate_hold_threshold_[gate] = hold;
+#ifdef USE_NUMBER
+    SAFE_PUBLISH_NUMBER(this->gate_trig_threshold_number_[gate], this->gate_trig_threshold_[gate]);
+    SAFE_PUBLISH_NUMBER(this->gate_hold_threshold_number_[gate], this->gate_hold_threshold_[gate]);
+#endif
+    applied++;
+  }
+  if (applied == 0) {
+    ESP_LOGW(TAG, "No gate has enough idle samples, thresholds unchanged");
+    return;
   }
+  ESP_LOGI(TAG, "Applying suggested thresholds to %" PRIu8 " gates", applied);
+  this->schedule_command_(CFG_GATE_THRESHOLDS_WRITE_CMD);
+  this->schedule_command_(CFG_GATE_SNRS_WRITE_CMD);
+}
+void LD2410SComponent::reset_noise_stats() {
+  if (this->noise_stats_ == nullptr)
+    return;
+  std::fill_n(this->noise_stats_.get(), TOTAL_GATES, GateNoiseStatsT{});
+  ESP_LOGD(TAG, "Noise statistics reset");
+}
 
-  switch (result) {
-    case RxEvaluationResult::OK:
-      this->payload_ready_ = true;
-      break;
+#pragma endregion
 
-    case RxEvaluationResult::UNKNOWN:
-      this->end_pos_++;
-      if (this->end_pos_ >= RX_TX_BUFFER_SIZE) {
-        ESP_LOGVV(TAG, "XX< [loop:%" PRIu32 "] Received data buffer overflow, resetting", loop_count);
-        this->reset();
-      }
-      break;
+#pragma region History
 
-    case RxEvaluationResult::NOK:
-    default:
-#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
-      char hex_buf[format_hex_pretty_size(RX_TX_BUFFER_SIZE)];
-      ESP_LOGVV(TAG, "<XX [loop:%" PRIu32 "] %s < %s", loop_count, this->msg_.c_str(),
-                format_hex_pretty_to(hex_buf, this->rcv_buffer_, end_pos_ + 1, ' '));
-#endif
-      this->reset();
-      result = RxEvaluationResult::UNKNOWN;
-      break;
+void LD2410SComponent::record_history_(bool has_energy) {
+  if (this->history_ == nullptr)
+    return;
+  uint32_t now = millis();
+  HistoryRecordT &record = this->history_[this->history_head_];
+  uint32_t elapsed = this->history_count_ == 0 ? 0 : (now - this->history_last_time_) / HISTORY_ELAPSED_UNIT;
+  record.elapsed = std::min<uint32_t>(elapsed, UINT8_MAX);
+  record.distance = std::min<uint16_t>(this->target_distance_, HISTORY_TARGET_FLAG - 1) |
+                    (this->has_target_ ? HISTORY_TARGET_FLAG : 0);
+  if (has_energy) {
+    std::copy(std::begin(this->gate_energy_), std::end(this->gate_energy_), record.gate_energy);
+  } else {
+    std::fill(std::begin(record.gate_energy), std::end(record.gate_energy), GATE_ENERGY_UNKNOWN);
+  }
+  this->history_last_time_ = now;
+  this->history_head_ = (this->history_head_ + 1) % this->history_size_;
+  this->history_written_++;
+  if (this->history_count_ < this->history_size_) {
+    this->history_count_++;
+  }
+}
+// logs the ring as it was when called, oldest first, times are relative to now
+// the logger can not take the whole ring in one message, so it is logged a chunk per loop pass to not stall the
+// loop; recording goes on meanwhile into the slots already logged
+void LD2410SComponent::dump_history() {
+  if (this->history_ == nullptr) {
+    ESP_LOGW(TAG, "History is not enabled");
+    return;
+  }
+  if (this->history_dump_count_ > 0) {
+    ESP_LOGW(TAG, "History is already being logged");
+    return;
+  }
+  uint16_t oldest = (this->history_head_ + this->history_size_ - this->history_count_) % this->history_size_;
+  // the first record's elapsed time is not part of the span
+  uint32_t age = millis() - this->history_last_time_;
+  for (uint16_t i = 1; i < this->history_count_; i++) {
+    age += this->history_[this->history_index_(oldest, i)].elapsed * HISTORY_ELAPSED_UNIT;
+  }
+  ESP_LOGI(TAG, "History: %" PRIu16 " frames, oldest first (age ms, target, distance cm, gate dB)",
+           this->history_count_);
+  this->history_dump_age_ = age;
+  this->history_dump_written_ = this->history_written_;
+  this->history_dump_oldest_ = oldest;
+  this->history_dump_count_ = this->history_count_;
+  this->history_dump_pos_ = 0;
+  this->dump_history_chunk_();
+}
+void LD2410SComponent::dump_history_chunk_() {
+  // new records fill the free slots first, then overwrite the snapshot from its oldest record on
+  uint32_t written = this->history_written_ - this->history_dump_written_;
+  uint32_t free = this->history_size_ - this->history_dump_count_;
+  if (written > free && written - free > this->history_dump_pos_) {
+    ESP_LOGW(TAG, "History overwritten while logging, stopped");
+    this->history_dump_count_ = 0;
+    return;
   }
+  uint16_t end = std::min<uint16_t>(this->history_dump_pos_ + HISTORY_DUMP_CHUNK, this->history_dump_count_);
+  for (uint16_t i = this->history_dump_pos_; i < end; i++) {
+    const HistoryRecordT &record = this->history_[this->history_index_(this->history_dump_oldest_, i)];
+    if (i > 0) {
+      this->history_dump_age_ -= record.elapsed * HISTORY_ELAPSED_UNIT;
+    }
+    char energy_s[65];
+    size_t pos = 0;
+    for (uint8_t gate = 0; gate < TOTAL_GATES; gate++) {
+      if (record.gate_energy[gate] == GATE_ENERGY_UNKNOWN) {
+        pos += snprintf(&energy_s[pos], sizeof(energy_s) - pos, gate == 0 ? "-" : ",-");
+      } else {
+        pos += snprintf(&energy_s[pos], sizeof(energy_s) - pos, gate == 0 ? "%" PRIu8 : ",%" PRIu8,
+                        record.gate_energy[gate]);
+      }
+    }
+    ESP_LOGI(TAG, "  -%" PRIu32 " %u %" PRIu16 " %s", this->history_dump_age_,
+             (record.distance & HISTORY_TARGET_FLAG) ? 1 : 0,
+             static_cast<uint16_t>(record.distance & ~HISTORY_TARGET_FLAG), energy_s);
+  }
+  this->history_dump_pos_ = end;
+  if (end < this->history_dump_count_) {
+    this->set_timeout("History Dump", 0, [this]() { this->dump_history_chunk_(); });
+    return;
+  }
+  this->history_dump_count_ = 0;
+}
+
+#pragma endregion
 
-  return result;
+#pragma region Config Shadow
+
+// copies the current radar configuration into a hashed shadow
+ConfigShadowT LD2410SComponent::get_config_shadow_() {
+  ConfigShadowT shadow{};
+  std::copy(std::begin(this->gate_trig_threshold_), std::end(this->gate_trig_threshold_), shadow.gate_trig_threshold);
+  std::copy(std::begin(this->gate_hold_threshold_), std::end(this->gate_hold_threshold_), shadow.gate_hold_threshold);
+  shadow.max_detect_gate = this->max_detect_gate_;
+  shadow.min_detect_gate = this->min_detect_gate_;
+  shadow.delay = this->delay_;
+  shadow.status_reporting_freq = this->status_reporting_freq_;
+  shadow.distance_reporting_freq = this->distance_reporting_freq_;
+  shadow.resp_speed = this->resp_speed_;
+  std::copy(std::begin(this->version_), std::end(this->version_), shadow.version);
+
+  // FNV-1a over everything but the hash itself
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&shadow);
+  uint32_t hash = 2166136261UL;
+  for (size_t i = 0; i < offsetof(ConfigShadowT, hash); i++) {
+    hash = (hash ^ bytes[i]) * 16777619UL;
+  }
+  shadow.hash = hash;
+  return shadow;
 }
-// checks if current rx buffer contains header
-RxEvaluationResult LD2410Srx::evaluate_header_(uint16_t end_pos) {
-  switch (this->frame_type_) {
-    case RxFrameType::CMD_FRAME:
-    case RxFrameType::STD_DATA_FRAME:
-    case RxFrameType::SHORT_DATA_FRAME:
-      return RxEvaluationResult::OK;  // already determined frame type
+// loads the persisted config and publishes it, returns false if there is no valid config
+bool LD2410SComponent::restore_config_shadow_() {
+  this->config_pref_ = global_preferences->make_preference<ConfigShadowT>(this->config_key_);
+  ConfigShadowT shadow{};
+  if (!this->config_pref_.load(&shadow)) {
+    ESP_LOGD(TAG, "No stored config, reading from radar");
+    return false;
+  }
 
-    case RxFrameType::NOK:
-      return RxEvaluationResult::NOK;  // already determined bad header
+  std::copy(std::begin(shadow.gate_trig_threshold), std::end(shadow.gate_trig_threshold), this->gate_trig_threshold_);
+  std::copy(std::begin(shadow.gate_hold_threshold), std::end(shadow.gate_hold_threshold), this->gate_hold_threshold_);
+  this->max_detect_gate_ = shadow.max_detect_gate;
+  this->min_detect_gate_ = shadow.min_detect_gate;
+  this->delay_ = shadow.delay;
+  this->status_reporting_freq_ = shadow.status_reporting_freq;
+  this->distance_reporting_freq_ = shadow.distance_reporting_freq;
+  this->resp_speed_ = shadow.resp_speed;
+  std::copy(std::begin(shadow.version), std::end(shadow.version), this->version_);
+
+  if (this->get_config_shadow_().hash != shadow.hash) {
+    ESP_LOGW(TAG, "Stored config is corrupted, reading from radar");
+    return false;
+  }
+  this->config_saved_hash_ = shadow.hash;
+  this->config_restored_hash_ = shadow.hash;
 
-    case RxFrameType::UNKNOWN:
-    default:
-      break;  // need to determine frame type
+  ESP_LOGD(TAG, "Restored config, verifying");
+  this->publish_config_();
+  this->publish_fw_version_();
+#ifdef USE_NUMBER
+  for (uint8_t gate = 0; gate < TOTAL_GATES; gate++) {
+    SAFE_PUBLISH_NUMBER(this->gate_trig_threshold_number_[gate], this->gate_trig_threshold_[gate]);
+    SAFE_PUBLISH_NUMBER(this->gate_hold_threshold_number_[gate], this->gate_hold_threshold_[gate]);
   }
+#endif
+  return true;
+}
 
-  if (end_pos == sizeof(SHORT_DATA_FRAME_HEADER) &&
-      memcmp(&this->rcv_buffer_[0], &SHORT_DATA_FRAME_HEADER, sizeof(SHORT_DATA_FRAME_HEADER)) == 0) {
-    this->frame_type_ = RxFrameType::SHORT_DATA_FRAME;
-    this->header_footer_size_ = sizeof(SHORT_DATA_FRAME_HEADER);
-    return RxEvaluationResult::OK;
+// compares the restored config with the radar config once all reads of the boot read-back arrived
+void LD2410SComponent::verify_config_shadow_() {
+  if (this->verify_reads_ == 0 || --this->verify_reads_ > 0)
+    return;
+  if (this->get_config_shadow_().hash == this->config_restored_hash_) {
+    ESP_LOGI(TAG, "Restored config verified");
+  } else {
+    ESP_LOGW(TAG, "Radar config or firmware differs from restored config, using the radar config");
   }
+}
+// saves the config once the radar is quiet, flash is written only when the config changed
+void LD2410SComponent::schedule_config_save_() {
+  if (!this->restore_config_)
+    return;
+  this->set_timeout("Save Config", 1000, [this]() { this->save_config_shadow_(); });
+}
+void LD2410SComponent::save_config_shadow_() {
+  ConfigShadowT shadow = this->get_config_shadow_();
+  if (shadow.hash == this->config_saved_hash_)
+    return;
+  if (this->config_pref_.save(&shadow)) {
+    this->config_saved_hash_ = shadow.hash;
+    ESP_LOGD(TAG, "Config stored");
+  } else {
+    ESP_LOGW(TAG, "Storing config failed");
+  }
+}
 
-  if (end_pos == sizeof(STD_DATA_FRAME_HEADER) &&
-      memcmp(&this->rcv_buffer_[0], &STD_DATA_FRAME_HEADER, sizeof(STD_DATA_FRAME_HEADER)) == 0) {
-    this->frame_type_ = RxFrameType::STD_DATA_FRAME;
-    this->header_footer_size_ = sizeof(STD_DATA_FRAME_HEADER);
-    return RxEvaluationResult::OK;
+#pragma endregion
+
+#pragma region LD2410SDistanceFilter
+
+bool LD2410SDistanceFilter::update(uint16_t distance, uint16_t &filtered) {
+  int32_t sample_q8 = static_cast<int32_t>(distance) << 8;
+  if (!this->initialized_) {
+    this->initialized_ = true;
+    this->position_q8_ = sample_q8;
+    this->velocity_q8_ = 0;
   }
 
-  if (end_pos == sizeof(CMD_FRAME_HEADER) &&
-      memcmp(&this->rcv_buffer_[0], &CMD_FRAME_HEADER, sizeof(CMD_FRAME_HEADER)) == 0) {
-    this->frame_type_ = RxFrameType::CMD_FRAME;
-    this->header_footer_size_ = sizeof(CMD_FRAME_HEADER);
-    return RxEvaluationResult::OK;
+  switch (this->type_) {
+    case DistanceFilterType::MEDIAN:
+      this->position_q8_ = static_cast<int32_t>(this->median_(distance)) << 8;
+      break;
+
+    case DistanceFilterType::EMA:
+      this->position_q8_ += (this->alpha_q8_ * (sample_q8 - this->position_q8_)) >> 8;
+      break;
+
+    case DistanceFilterType::ALPHA_BETA: {
+      // predict one frame ahead, then correct position and velocity by the residual
+      this->position_q8_ += this->velocity_q8_;
+      int32_t residual_q8 = sample_q8 - this->position_q8_;
+      this->position_q8_ += (this->alpha_q8_ * residual_q8) >> 8;
+      this->velocity_q8_ += (this->beta_q8_ * residual_q8) >> 8;
+      break;
+    }
+
+    case DistanceFilterType::NONE:
+    default:
+      this->position_q8_ = sample_q8;
+      break;
   }
 
-  if (end_pos < sizeof(STD_DATA_FRAME_HEADER) && memcmp(&this->rcv_buffer_[0], &STD_DATA_FRAME_HEADER, end_pos) == 0) {
-    this->frame_type_ =
-        RxFrameType::UNKNOWN;  // not enough data yet to determine frame type, but it fits STD frame header
-    this->header_footer_size_ = 0;
-    return RxEvaluationResult::UNKNOWN;
+  uint16_t value = std::max<int32_t>((this->position_q8_ + 128) >> 8, 0);
+  if (this->has_published_ && std::abs(value - this->published_) <= this->deadband_) {
+    return false;
+  }
+  this->has_published_ = true;
+  this->published_ = value;
+  filtered = value;
+  return true;
+}
+// median of the last window_size_ distances
+uint16_t LD2410SDistanceFilter::median_(uint16_t distance) {
+  this->window_[this->window_pos_] = distance;
+  this->window_pos_ = (this->window_pos_ + 1) % this->window_size_;
+  if (this->window_count_ < this->window_size_) {
+    this->window_count_++;
   }
 
-  if (end_pos < sizeof(CMD_FRAME_HEADER) && memcmp(&this->rcv_buffer_[0], &CMD_FRAME_HEADER, end_pos) == 0) {
-    this->frame_type_ =
-        RxFrameType::UNKNOWN;  // not enough data yet to determine frame type, but it fits CMD frame header
-    this->header_footer_size_ = 0;
-    return RxEvaluationResult::UNKNOWN;
+  uint16_t sorted[DISTANCE_MEDIAN_MAX_WINDOW];
+  for (uint8_t i = 0; i < this->window_count_; i++) {
+    uint16_t value = this->window_[i];
+    uint8_t j = i;
+    for (; j > 0 && sorted[j - 1] > value; j--) {
+      sorted[j] = sorted[j - 1];
+    }
+    sorted[j] = value;
   }
+  return sorted[this->window_count_ / 2];
+}
+void LD2410SDistanceFilter::reset() {
+  this->initialized_ = false;
+  this->has_published_ = false;
+  this->window_count_ = 0;
+  this->window_pos_ = 0;
+}
+
+#pragma endregion
+
+#pragma region LD2410Srx
 
-  this->msg_ = "Unknown header";
-  this->frame_type_ = RxFrameType::NOK;  // bad header
-  return RxEvaluationResult::NOK;
+// moves a partially received frame to the start of the buffer, only when the buffer end has been reached
+size_t LD2410Srx::prepare_write() {
+  if (this->start_pos_ == this->end_pos_) {
+    this->start_pos_ = 0;
+    this->end_pos_ = 0;
+  } else if (this->end_pos_ == RX_TX_BUFFER_SIZE && this->start_pos_ > 0) {
+    this->end_pos_ -= this->start_pos_;
+    std::memmove(this->rcv_buffer_, &this->rcv_buffer_[this->start_pos_], this->end_pos_);
+    this->start_pos_ = 0;
+  }
+  if (this->end_pos_ == RX_TX_BUFFER_SIZE) {
+    ESP_LOGVV(TAG, "XX< Received data buffer overflow, resetting");
+    this->stats_.overflows++;
+    this->stats_.discarded += this->end_pos_;
+    this->reset();
+  }
+  return RX_TX_BUFFER_SIZE - this->end_pos_;
 }
-// checks if current rx buffer has proper size for decoded header
-RxEvaluationResult LD2410Srx::evaluate_size_(uint16_t end_pos) {
-  switch (this->frame_type_) {
-    case RxFrameType::SHORT_DATA_FRAME:
-      if (this->expected_frame_size_ == 0) {
-        this->size_field_size_ = 0;
-        this->payload_size_ = 3;
-        this->payload_pos_ = this->header_footer_size_;
-        this->expected_frame_size_ = 2 * this->header_footer_size_ + 3;
-      }
-      break;
+// finds the next complete frame, bytes that can't start a frame are skipped
+bool LD2410Srx::next_frame(uint32_t loop_count) {
+  while (this->start_pos_ < this->end_pos_) {
+    uint16_t pos = this->start_pos_;
+    while (pos < this->end_pos_) {
+      uint8_t byte = this->rcv_buffer_[pos];
+      if (byte == SHORT_DATA_FRAME_HEADER || byte == STD_DATA_FRAME_HEADER_START || byte == CMD_FRAME_HEADER_START)
+        break;
+      pos++;
+    }
+    if (pos != this->start_pos_) {
+      this->discard_(pos - this->start_pos_, loop_count, "Unknown header");
+      if (pos == this->end_pos_)
+        return false;
+    }
 
-    case RxFrameType::STD_DATA_FRAME:
-    case RxFrameType::CMD_FRAME:
-      if (this->expected_frame_size_ == 0) {
-        this->size_field_size_ = FRAME_DATA_LENGTH_SIZE;
-        if (end_pos - 1 >= this->header_footer_size_ + this->size_field_size_) {
-          this->payload_size_ = read_int(this->rcv_buffer_, this->header_footer_size_, 2);
-          uint16_t overhead = 2 * this->header_footer_size_ + this->size_field_size_;
-          if (this->payload_size_ > RX_TX_BUFFER_SIZE - overhead) {
-            this->msg_ = "payload size exceeds buffer capacity";
-            return RxEvaluationResult::NOK;
-          }
-          this->payload_pos_ = this->header_footer_size_ + this->size_field_size_;
-          this->expected_frame_size_ = overhead + this->payload_size_;
+    switch (this->evaluate_frame_()) {
+      case RxEvaluationResult::OK:
+        this->start_pos_ += this->frame_size_;
+        if (this->frame_type_ == RxFrameType::SHORT_DATA_FRAME) {
+          this->stats_.short_frames++;
+        } else if (this->frame_type_ == RxFrameType::STD_DATA_FRAME) {
+          this->stats_.std_frames++;
+        } else {
+          this->stats_.cmd_frames++;
         }
-      }
-      break;
+        return true;
 
-    case RxFrameType::UNKNOWN:
-      return RxEvaluationResult::UNKNOWN;  // not enough data yet to determine size
-    case RxFrameType::NOK:                 // already determined bad header
-    default:                               // unknown header type
-      return RxEvaluationResult::NOK;
-  }
+      case RxEvaluationResult::UNKNOWN:
+        return false;  // not enough data yet
 
-  if (this->expected_frame_size_ == 0 || end_pos < this->expected_frame_size_) {
-    return RxEvaluationResult::UNKNOWN;  // not enough data yet to determine size
-  } else if (end_pos > this->expected_frame_size_) {
-    char msg_buf[48];
-    snprintf(msg_buf, sizeof(msg_buf), "rx passed the expected frame, expected:%" PRIu8, this->expected_frame_size_);
-    this->msg_ = msg_buf;
-    return RxEvaluationResult::NOK;  // passed the end of short data frame
-  } else {
-    return RxEvaluationResult::OK;  // correct size
+      case RxEvaluationResult::NOK:
+      default:
+        this->discard_(1, loop_count, "Bad frame, resync");
+        break;
+    }
   }
+  return false;
 }
-// checks if current rx buffer containts proper footer for decoded header
-RxEvaluationResult LD2410Srx::evaluate_footer_(uint16_t end_pos) {
-  switch (this->frame_type_) {
-    case RxFrameType::SHORT_DATA_FRAME:  // footer matches expected for short data frame
-      if (memcmp(&rcv_buffer_[end_pos - this->header_footer_size_], &SHORT_DATA_FRAME_FOOTER,
-                 sizeof(SHORT_DATA_FRAME_FOOTER)) == 0) {
-        return RxEvaluationResult::OK;
-      }
+// checks header, size and footer of the frame starting at start_pos_ in place
+RxEvaluationResult LD2410Srx::evaluate_frame_() {
+  const uint8_t *data = &this->rcv_buffer_[this->start_pos_];
+  uint16_t received = this->end_pos_ - this->start_pos_;
+  uint16_t header_footer_size;
+  const void *header;
+  const void *footer;
+
+  switch (data[0]) {
+    case SHORT_DATA_FRAME_HEADER:
+      this->frame_type_ = RxFrameType::SHORT_DATA_FRAME;
+      header_footer_size = sizeof(SHORT_DATA_FRAME_HEADER);
+      header = &SHORT_DATA_FRAME_HEADER;
+      footer = &SHORT_DATA_FRAME_FOOTER;
       break;
 
-    case RxFrameType::STD_DATA_FRAME:  // footer matches expected for standard data frame
-      if (memcmp(&rcv_buffer_[end_pos - this->header_footer_size_], &STD_DATA_FRAME_FOOTER,
-                 sizeof(STD_DATA_FRAME_FOOTER)) == 0) {
-        return RxEvaluationResult::OK;
-      }
+    case STD_DATA_FRAME_HEADER_START:
+      this->frame_type_ = RxFrameType::STD_DATA_FRAME;
+      header_footer_size = sizeof(STD_DATA_FRAME_HEADER);
+      header = &STD_DATA_FRAME_HEADER;
+      footer = &STD_DATA_FRAME_FOOTER;
       break;
 
-    case RxFrameType::CMD_FRAME:  // footer matches expected for command frame
-      if (memcmp(&rcv_buffer_[end_pos - this->header_footer_size_], &CMD_FRAME_FOOTER, sizeof(CMD_FRAME_FOOTER)) == 0) {
-        return RxEvaluationResult::OK;
-      }
+    case CMD_FRAME_HEADER_START:
+      this->frame_type_ = RxFrameType::CMD_FRAME;
+      header_footer_size = sizeof(CMD_FRAME_HEADER);
+      header = &CMD_FRAME_HEADER;
+      footer = &CMD_FRAME_FOOTER;
       break;
 
-    case RxFrameType::UNKNOWN:  // not enough data yet to determine size
+    default:
+      this->frame_type_ = RxFrameType::NOK;
+      return RxEvaluationResult::NOK;
+  }
+
+  if (memcmp(data, header, std::min(received, header_footer_size)) != 0)
+    return RxEvaluationResult::NOK;
+
+  if (this->frame_type_ == RxFrameType::SHORT_DATA_FRAME) {
+    this->payload_offset_ = header_footer_size;
+    this->payload_size_ = 3;
+  } else {
+    if (received < header_footer_size + FRAME_DATA_LENGTH_SIZE)
       return RxEvaluationResult::UNKNOWN;
-    case RxFrameType::NOK:  // already known bad data frame
-    default:                // unknown header type
-      break;
+    this->payload_offset_ = header_footer_size + FRAME_DATA_LENGTH_SIZE;
+    this->payload_size_ = encode_uint16(data[header_footer_size + 1], data[header_footer_size]);
+    if (this->payload_size_ > RX_TX_BUFFER_SIZE - this->payload_offset_ - header_footer_size)
+      return RxEvaluationResult::NOK;  // payload size exceeds buffer capacity
   }
-  this->msg_ = "footer does not match header: ";
-  return RxEvaluationResult::NOK;  // footer does not match expected footer for frame type
+  this->frame_size_ = this->payload_offset_ + this->payload_size_ + header_footer_size;
+
+  if (received < this->frame_size_)
+    return RxEvaluationResult::UNKNOWN;
+
+  if (memcmp(&data[this->frame_size_ - header_footer_size], footer, header_footer_size) != 0)
+    return RxEvaluationResult::NOK;  // footer does not match header
+
+  this->frame_pos_ = this->start_pos_;
+  return RxEvaluationResult::OK;
+}
+// drops bytes from the start of the unprocessed data
+void LD2410Srx::discard_(uint16_t count, uint32_t loop_count, const char *reason) {
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
+  char hex_buf[format_hex_pretty_size(RX_TX_BUFFER_SIZE)];
+  ESP_LOGVV(TAG, "<XX [loop:%" PRIu32 "] %s < %s", loop_count, reason,
+            format_hex_pretty_to(hex_buf, &this->rcv_buffer_[this->start_pos_], count, ' '));
+#endif
+  this->start_pos_ += count;
+  this->stats_.discarded += count;
 }
 // reset rx buffer
 void LD2410Srx::reset() {
-  // ESP_LOGV(TAG, "rx reset");
-  std::memset(this->rcv_buffer_, 0, RX_TX_BUFFER_SIZE);
+  this->start_pos_ = 0;
   this->end_pos_ = 0;
-  this->header_footer_size_ = 0;
-  this->size_field_size_ = 0;
   this->frame_type_ = RxFrameType::UNKNOWN;
-  this->payload_ready_ = false;
-  this->payload_pos_ = 0;
+  this->frame_pos_ = 0;
+  this->frame_size_ = 0;
+  this->payload_offset_ = 0;
   this->payload_size_ = 0;
-  this->expected_frame_size_ = 0;
 }
 
-int LD2410Srx::read_int(const uint8_t *buffer, size_t pos, size_t len) {
-  unsigned int ret = 0;
-  int shift = 0;
-  for (size_t i = 0; i < len; i++) {
-    ret |= static_cast<unsigned int>(buffer[pos + i]) << shift;
-    shift += 8;
-  }
-  return ret;
-};
-
 #pragma endregion
 
 #pragma region LD2410Sschedule
 
+// Merges new task into a matching task that is not sent yet, returns true if merged
+bool LD2410Sschedule::merge_(uint16_t command, uint16_t sub_command) {
+  // active task is pending until its frame is built and written
+  uint8_t first_pending =
+      this->state_ == TxCmdState::SCHEDULED || this->state_ == TxCmdState::SEND ? this->active_ : this->active_ + 1;
+  bool is_read = command == CFG_FW_READ_CMD || command == CFG_PARAMS_READ_CMD ||
+                 command == CFG_GATE_THRESHOLDS_READ_CMD || command == CFG_GATE_SNRS_READ_CMD;
+
+  for (int16_t pos = this->last_ - 1; pos >= first_pending; pos--) {
+    TxTaskT &task = this->commands_[pos];
+    if (task.command != command) {
+      // a read must not be moved before a pending write, it could return stale values
+      if (is_read && task.command != CONFIG_MODE_START_CMD && task.command != CONFIG_MODE_END_CMD &&
+          task.command != CFG_FW_READ_CMD && task.command != CFG_PARAMS_READ_CMD &&
+          task.command != CFG_GATE_THRESHOLDS_READ_CMD && task.command != CFG_GATE_SNRS_READ_CMD) {
+        return false;
+      }
+      continue;
+    }
+
+    if (task.sub_command == sub_command || task.sub_command == NO_SUB_CMD) {
+      ESP_LOGV(TAG, "==: pos:[%" PRIi16 "], cmd:%04" PRIX16 ", already scheduled", pos, command);
+    } else if (command == CFG_PARAMS_WRITE_CMD) {
+      // write all modified parameters with one frame
+      uint16_t mask = (task.sub_command & PARAMS_MASK_SUB_CMD) != 0 ? task.sub_command
+                                                                      : PARAMS_MASK_SUB_CMD | (1 << task.sub_command);
+      task.sub_command = (sub_command & PARAMS_MASK_SUB_CMD) != 0 ? mask | sub_command : mask | (1 << sub_command);
+      ESP_LOGV(TAG, "==: pos:[%" PRIi16 "], cmd:%04" PRIX16 ", merged params:%04" PRIX16, pos, command,
+               task.sub_command);
+    } else {
+      // different gates or values, read or write the whole table instead
+      task.sub_command = NO_SUB_CMD;
+      ESP_LOGV(TAG, "==: pos:[%" PRIi16 "], cmd:%04" PRIX16 ", merged to full frame", pos, command);
+    }
+    return true;
+  }
+  return false;
+}
 // Appends new task to schedule
 void LD2410Sschedule::append(uint16_t command, uint16_t sub_command) {
+  if (command != CONFIG_MODE_START_CMD && command != CONFIG_MODE_END_CMD && this->merge_(command, sub_command)) {
+    return;
+  }
+
   if (this->last_ > 0) {
     ESP_LOGVV(TAG, "append => cmd:%04" PRIX16 ", prev_cmd:%04" PRIX16 ", active:%" PRIu8 ", last:%" PRIu8, command,
               this->commands_[this->last_ - 1].command, this->active_, this->last_);
@@ -1093,53 +1675,57 @@ void LD2410Sschedule::append(uint16_t command, uint16_t sub_command) {
   }
 }
 // Returns active scheduled task status
-TxCmdState LD2410Sschedule::check_state(uint32_t loop_count) {
+TxCmdState LD2410Sschedule::check_state(uint32_t now) {
   switch (this->state_) {
     case TxCmdState::SCHEDULED:
       this->retry_count_ = 0;
-      ESP_LOGVV(TAG, "::> [loop:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", Scheduled", loop_count,
+      ESP_LOGVV(TAG, "::> [ms:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", Scheduled", now,
                 this->active_, this->last_ - 1, this->get_command());
       break;
 
     case TxCmdState::SEND:
-      this->time_started_ = App.get_loop_component_start_time();
-      ESP_LOGVV(TAG, "::> [loop:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", Send", loop_count,
+      this->time_started_ = now;
+      ESP_LOGVV(TAG, "::> [ms:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", Send", now,
                 this->active_, this->last_ - 1, this->get_command());
       break;
 
     case TxCmdState::SENT:
-      if (App.get_loop_component_start_time() > this->time_started_ + TX_CONFIRMATION_TIMEOUT) {
-        this->time_started_ = App.get_loop_component_start_time();
+      if (now - this->time_started_ >= TX_CONFIRMATION_TIMEOUT) {
+        this->time_started_ = now;
+        this->ack_latency_ = TX_PAUSE_TIMEOUT;  // back off to the slowest pacing
 
         if (this->retry_count_ < TX_MAX_RESEND) {
           ESP_LOGVV(TAG,
-                    ":>> [loop:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", retry:%" PRIu8
+                    ":>> [ms:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", retry:%" PRIu8
                     ", restart:%" PRIu8,
-                    loop_count, this->active_, this->last_ - 1, this->get_command(), this->retry_count_,
+                    now, this->active_, this->last_ - 1, this->get_command(), this->retry_count_,
                     this->restart_count_);
           ESP_LOGD(TAG, "Send Timeout Expired, Resend!");
           this->state_ = TxCmdState::SEND;
           this->retry_count_++;
+          this->stats_.retries++;
         } else {
           if (this->restart_count_ < TX_MAX_RESTART) {
             ESP_LOGVV(TAG,
-                      ":>> [loop:%" PRIu32 "] pos:%" PRIu8 "[:%" PRIu8 "], cmd:%04" PRIX16 ", retry:%" PRIu8
+                      ":>> [ms:%" PRIu32 "] pos:%" PRIu8 "[:%" PRIu8 "], cmd:%04" PRIX16 ", retry:%" PRIu8
                       ", restart:%" PRIu8 ", Resend limit reached, Restart sequence!!",
-                      loop_count, this->active_, this->last_ - 1, this->get_command(), this->retry_count_,
+                      now, this->active_, this->last_ - 1, this->get_command(), this->retry_count_,
                       this->restart_count_);
             ESP_LOGD(TAG, "Resend limit reached, Restart sequence!!");
             this->state_ = TxCmdState::SCHEDULED;
             this->retry_count_ = 0;
             this->restart_count_++;
+            this->stats_.restarts++;
             this->active_ = 0;
           } else {
             ESP_LOGVV(TAG,
-                      ":>> [loop:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", retry:%" PRIu8
+                      ":>> [ms:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", retry:%" PRIu8
                       ", restart:%" PRIu8 ", Restart sequence limit reached, Giving up, "
                       "Reseting buffer!!!",
-                      loop_count, this->active_, this->last_ - 1, this->get_command(), this->retry_count_,
+                      now, this->active_, this->last_ - 1, this->get_command(), this->retry_count_,
                       this->restart_count_);
             ESP_LOGE(TAG, "Restart sequence limit reached, Giving up, Reseting buffer!!!");
+            this->stats_.failures++;
             this->state_ = TxCmdState::FAILED;
             this->retry_count_ = 0;
             this->restart_count_ = 0;
@@ -1164,15 +1750,15 @@ TxCmdState LD2410Sschedule::check_state(uint32_t loop_count) {
   return this->state_;
 }
 // Verifies if received response matches expected, if so procedes to next scheduled command
-void LD2410Sschedule::verify_response(uint16_t command_word, uint32_t loop_count) {
+bool LD2410Sschedule::verify_response(uint16_t command_word, uint32_t now) {
   int16_t expected = this->get_command() | CMD_CONFIRMATION;
   if (this->state_ == TxCmdState::SENT) {
     if (command_word == expected) {
 #if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
       ESP_LOGV(TAG, "Sent cmd: %04" PRIX16, this->get_command());
       ESP_LOGVV(
-          TAG, "::< [loop:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", Sending confirmed, rx:%04" PRIX16,
-          loop_count, this->active_, this->last_ - 1, this->get_command(), command_word);
+          TAG, "::< [ms:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", Sending confirmed, rx:%04" PRIX16,
+          now, this->active_, this->last_ - 1, this->get_command(), command_word);
 #endif
 
       switch (command_word) {
@@ -1190,6 +1776,11 @@ void LD2410Sschedule::verify_response(uint16_t command_word, uint32_t loop_count
           break;
       }
 
+      // learn ack latency for pacing
+      uint32_t latency = now - this->time_started_;
+      this->ack_latency_ = (this->ack_latency_ * 3 + latency) / 4;
+      ESP_LOGVV(TAG, "Ack latency:%" PRIu32 " ms, average:%" PRIu32 " ms", latency, this->ack_latency_);
+
       // procede to next task
       this->active_++;
       this->state_ = TxCmdState::SCHEDULED;
@@ -1203,36 +1794,38 @@ void LD2410Sschedule::verify_response(uint16_t command_word, uint32_t loop_count
         ESP_LOGW(TAG, "Schedule overflow, Reseting");
         this->reset_schedule();
       }
+      return true;
     } else {
       if (this->active_ > 0 && command_word == (this->commands_[this->active_ - 1].command | CMD_CONFIRMATION)) {
         ESP_LOGVV(TAG,
-                  "::< [loop:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", received:%04" PRIX16
+                  "::< [ms:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", received:%04" PRIX16
                   ", Received unexpected confirmation for previous command",
-                  loop_count, this->active_, this->last_, this->get_command(), command_word);
+                  now, this->active_, this->last_, this->get_command(), command_word);
         ESP_LOGW(TAG, "Received unexpected confirmation for previous command");
       } else {
         ESP_LOGVV(TAG,
-                  "::< [loop:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", received:%04" PRIX16
+                  "::< [ms:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", received:%04" PRIX16
                   ", Received confirmation for wrong command",
-                  loop_count, this->active_, this->last_, this->get_command(), command_word);
+                  now, this->active_, this->last_, this->get_command(), command_word);
         ESP_LOGW(TAG, "Received confirmation for wrong command");
       }
     }
   } else {
     ESP_LOGVV(TAG,
-              "::< [loop:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", received:%04" PRIX16
+              "::< [ms:%" PRIu32 "] pos:%" PRIu8 "[%" PRIu8 "], cmd:%04" PRIX16 ", received:%04" PRIX16
               ", Received unexpected command confirmation",
-              loop_count, this->active_, this->last_, this->get_command(), command_word);
+              now, this->active_, this->last_, this->get_command(), command_word);
     ESP_LOGW(TAG, "Received unexpected command confirmation");
   }
+  return false;
 }
 
 // Confirm frame ready for sending
 void LD2410Sschedule::confirm_ready_to_send() { this->state_ = TxCmdState::SEND; }
 
 // Confirm frame sent
-void LD2410Sschedule::confirm_sent() {
-  this->time_started_ = App.get_loop_component_start_time();
+void LD2410Sschedule::confirm_sent(uint32_t now) {
+  this->time_started_ = now;
   this->state_ = TxCmdState::SENT;
   this->config_mode_ = true;
 }
@@ -6,6 +6,7 @@
 #include "esphome/core/defines.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
 
 // components
 #ifdef USE_SENSOR
@@ -33,8 +34,13 @@
 #include "esphome/components/uart/uart.h"
 
 // std
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
 
 namespace esphome::ld2410s {
 
@@ -44,6 +50,7 @@ using namespace ld24xx;
 static constexpr uint8_t TOTAL_GATES = 16;  // Total number of gates supported by the LD2410S
 
 static const uint16_t NO_SUB_CMD = 0xffff;
+static const uint16_t PARAMS_MASK_SUB_CMD = 0x8000;  // sub command flag, lower bits select the parameter ids
 static const uint16_t FRAME_DATA_LENGTH_SIZE = 2;
 static const size_t RX_TX_BUFFER_SIZE = 128;
 static const uint16_t RX_MAX_BYTES_PER_LOOP = 128;
@@ -51,7 +58,16 @@ static const uint8_t TX_SCHEDULE_BUFFER_SIZE = 32;
 static const uint8_t TX_MAX_RESEND = 5;
 static const uint8_t TX_MAX_RESTART = 5;
 static const uint32_t TX_CONFIRMATION_TIMEOUT = 1000;  // timeout for waiting for cmd response
-static const uint32_t TX_PAUSE_TIMEOUT = 100;          // pause after receiving response
+static const uint32_t TX_PAUSE_TIMEOUT = 100;          // pause after receiving response, upper bound of the pacing
+static const uint32_t TX_PAUSE_MIN = 10;               // lower bound of the pacing learned from ack latency
+static const uint8_t DISTANCE_MEDIAN_MAX_WINDOW = 9;
+static const uint32_t LINK_STATS_INTERVAL = 60000;     // diagnostic sensors publish interval without stats_interval
+static const uint32_t NOISE_STATS_MIN_SAMPLES = 50;    // idle frames needed before suggesting gate thresholds
+static const uint16_t NOISE_P95_STEP_UP = 61;          // 95th percentile estimate steps in 1/256 dB
+static const uint16_t NOISE_P95_STEP_DOWN = 3;
+static const uint16_t HISTORY_TARGET_FLAG = 0x8000;  // has target bit of a history record distance
+static const uint8_t HISTORY_ELAPSED_UNIT = 16;       // ms per step of a history record elapsed time
+static const uint16_t HISTORY_DUMP_CHUNK = 20;        // history records logged per loop pass
 #pragma endregion
 
 #pragma region enum
@@ -59,6 +75,8 @@ enum class TxCmdState { IDLE, SCHEDULED, SEND, SENT, FAILED };
 enum class RxFrameType { UNKNOWN, SHORT_DATA_FRAME, STD_DATA_FRAME, CMD_FRAME, NOK };
 enum class RxEvaluationResult { UNKNOWN, OK, NOK };
 enum class ResponseSpeed : uint8_t { NORMAL = 0, FAST };
+enum class GateEnergyAggregation : uint8_t { LAST = 0, MAX, MEAN };
+enum class DistanceFilterType : uint8_t { NONE = 0, MEDIAN, EMA, ALPHA_BETA };
 #pragma endregion
 
 #pragma region struct
@@ -66,57 +84,166 @@ struct TxTaskT {
   uint16_t command;
   uint16_t sub_command;
 };
+
+// last known radar configuration, persisted to skip the read-back at boot
+struct ConfigShadowT {
+  uint32_t gate_trig_threshold[16];
+  uint32_t gate_hold_threshold[16];
+  uint32_t max_detect_gate;
+  uint32_t min_detect_gate;
+  uint32_t delay;
+  uint32_t status_reporting_freq;
+  uint32_t distance_reporting_freq;
+  uint32_t resp_speed;
+  uint16_t version[3];
+  uint16_t reserved;
+  uint32_t hash;  // over all fields above
+};
+
+// constant memory noise floor statistics of one gate
+struct GateNoiseStatsT {
+  uint32_t count;
+  float mean;
+  float m2;      // sum of squared differences from the mean
+  uint16_t p95;  // streaming 95th percentile estimate in 1/256 dB
+};
+
+#ifdef USE_BINARY_SENSOR
+// distance interval driving a binary sensor
+struct ZoneT {
+  binary_sensor::BinarySensor *sensor;
+  uint16_t min_distance;  // cm
+  uint16_t max_distance;  // cm
+  uint16_t hysteresis;    // cm the interval grows by while occupied
+  uint32_t enter_delay;   // ms
+  uint32_t exit_delay;    // ms
+  uint32_t pending_since;
+  bool pending;
+  bool occupied;
+};
+#endif
+
+// one standard data frame in the history ring, packed to 19 bytes
+struct HistoryRecordT {
+  uint16_t distance;        // cm, HISTORY_TARGET_FLAG set while a target is present
+  uint8_t elapsed;          // HISTORY_ELAPSED_UNIT steps since the previous record, saturated
+  uint8_t gate_energy[16];  // dB, 0xFF if the frame had no energies
+} __attribute__((packed));
+static_assert(sizeof(HistoryRecordT) < 20, "HistoryRecordT must stay below 20 bytes");
+
+struct RxStatsT {
+  uint32_t bytes;
+  uint32_t discarded;  // bytes dropped while resynchronizing to a frame header
+  uint32_t overflows;
+  uint32_t short_frames;
+  uint32_t std_frames;
+  uint32_t cmd_frames;
+};
+
+struct TxStatsT {
+  uint32_t retries;
+  uint32_t restarts;
+  uint32_t failures;
+};
 #pragma endregion
 
 class LD2410Srx {
  public:
-  RxEvaluationResult receive_byte(uint32_t loop_count, uint8_t byte);
+  // makes room for new bytes, returns how many bytes can be written at write_ptr()
+  size_t prepare_write();
+  uint8_t *write_ptr() { return &this->rcv_buffer_[this->end_pos_]; }
+  void commit_write(size_t len) {
+    this->end_pos_ += len;
+    this->stats_.bytes += len;
+  }
+  // scans received bytes for the next complete frame, frame stays valid until the next prepare_write()
+  bool next_frame(uint32_t loop_count);
 
   RxFrameType frame_type() const { return this->frame_type_; }
-  uint8_t *frame_data() { return this->rcv_buffer_; }
-  uint8_t frame_size() const { return this->end_pos_; }
+  uint8_t *frame_data() { return &this->rcv_buffer_[this->frame_pos_]; }
+  uint8_t frame_size() const { return this->frame_size_; }
 
-  uint8_t *payload_data() { return &this->rcv_buffer_[this->payload_pos_]; }
+  uint8_t *payload_data() { return &this->rcv_buffer_[this->frame_pos_ + this->payload_offset_]; }
   uint8_t payload_size() const { return this->payload_size_; }
-  bool payload_ready() const { return payload_ready_; }
 
   void reset();
 
- protected:
-  uint8_t rcv_buffer_[RX_TX_BUFFER_SIZE] = {};
-  uint16_t end_pos_{0};
+  const RxStatsT &stats() const { return this->stats_; }
+  void reset_stats() { this->stats_ = {}; }
 
-  uint16_t header_footer_size_{0};
-  uint16_t expected_frame_size_{0};
-  uint16_t size_field_size_{0};
-
-  uint16_t payload_pos_{0};
+ protected:
+  uint8_t rcv_buffer_[RX_TX_BUFFER_SIZE];
+  RxStatsT stats_{};
+  uint16_t start_pos_{0};  // first byte not yet consumed by the scanner
+  uint16_t end_pos_{0};    // one past the last received byte
+
+  uint16_t frame_pos_{0};
+  uint16_t frame_size_{0};
+  uint16_t payload_offset_{0};
   uint16_t payload_size_{0};
   RxFrameType frame_type_{RxFrameType::UNKNOWN};
-  bool payload_ready_{false};
 
-  std::string msg_{""};
+  RxEvaluationResult evaluate_frame_();
+  void discard_(uint16_t count, uint32_t loop_count, const char *reason);
+};
+
+// fixed point target distance filter with deadband, all values in cm
+class LD2410SDistanceFilter {
+ public:
+  void set_type(DistanceFilterType type) { this->type_ = type; }
+  void set_window_size(uint8_t window_size) { this->window_size_ = window_size; }
+  void set_alpha(float alpha) { this->alpha_q8_ = alpha * 256; }
+  void set_beta(float beta) { this->beta_q8_ = beta * 256; }
+  void set_deadband(uint16_t deadband) { this->deadband_ = deadband; }
+  DistanceFilterType get_type() const { return this->type_; }
+
+  // filters a new distance, returns true with the distance to publish once it moved by more than the deadband
+  bool update(uint16_t distance, uint16_t &filtered);
+  void reset();
 
-  RxEvaluationResult evaluate_header_(uint16_t end_pos);
-  RxEvaluationResult evaluate_size_(uint16_t end_pos);
-  RxEvaluationResult evaluate_footer_(uint16_t end_pos);
-  static int read_int(const uint8_t *buffer, size_t pos, size_t len);
+ protected:
+  uint16_t median_(uint16_t distance);
+
+  uint16_t window_[DISTANCE_MEDIAN_MAX_WINDOW] = {};
+  int32_t position_q8_{0};  // cm * 256
+  int32_t velocity_q8_{0};  // cm per frame * 256
+  uint16_t alpha_q8_{77};   // 0.3
+  uint16_t beta_q8_{13};    // 0.05
+  uint16_t deadband_{0};
+  uint16_t published_{0};
+  uint8_t window_size_{5};
+  uint8_t window_count_{0};
+  uint8_t window_pos_{0};
+  DistanceFilterType type_{DistanceFilterType::NONE};
+  bool initialized_{false};
+  bool has_published_{false};
 };
 
 class LD2410Sschedule {
  public:
   void append(uint16_t command, uint16_t sub_command = NO_SUB_CMD);
-  TxCmdState check_state(uint32_t loop_count);
+  TxCmdState check_state(uint32_t now);
   void confirm_ready_to_send();
-  void confirm_sent();
-  void verify_response(uint16_t command_word, uint32_t loop_count);
+  void confirm_sent(uint32_t now);
+  bool verify_response(uint16_t command_word, uint32_t now);
+  // pause before the next command, follows the measured ack latency
+  uint32_t get_pause() const { return std::clamp(this->ack_latency_, TX_PAUSE_MIN, TX_PAUSE_TIMEOUT); }
+  uint32_t get_ack_latency() const { return this->ack_latency_; }
+
+  const TxStatsT &stats() const { return this->stats_; }
+  void reset_stats() { this->stats_ = {}; }
   void reset_schedule();
+  bool is_idle() const { return this->state_ == TxCmdState::IDLE; }
   uint16_t get_command();
   uint16_t get_sub_command();
 
  protected:
+  bool merge_(uint16_t command, uint16_t sub_command);
+
   TxTaskT commands_[TX_SCHEDULE_BUFFER_SIZE] = {};
+  TxStatsT stats_{};
   uint32_t time_started_{0};
+  uint32_t ack_latency_{TX_PAUSE_TIMEOUT};  // moving average in ms
   uint8_t retry_count_{0};
   uint8_t restart_count_{0};
   uint8_t last_{0};
@@ -147,6 +274,12 @@ class LD2410SComponent final : public Component, public uart::UARTDevice {
 #ifdef USE_SENSOR
   SUB_SENSOR_WITH_DEDUP(target_distance, uint16_t)
   SUB_SENSOR_WITH_DEDUP(cal_progress, uint16_t)
+  SUB_SENSOR_WITH_DEDUP(frame_rate, float)
+  SUB_SENSOR_WITH_DEDUP(resync_bytes, uint32_t)
+  SUB_SENSOR_WITH_DEDUP(buffer_overflows, uint32_t)
+  SUB_SENSOR_WITH_DEDUP(command_retries, uint32_t)
+  SUB_SENSOR_WITH_DEDUP(command_restarts, uint32_t)
+  SUB_SENSOR_WITH_DEDUP(ack_latency, uint32_t)
 #endif
 #ifdef USE_SWITCH
   SUB_SWITCH(minimal_output)
@@ -162,6 +295,12 @@ class LD2410SComponent final : public Component, public uart::UARTDevice {
   float get_setup_priority() const override;
 
   // button
+#ifdef USE_BINARY_SENSOR
+  void add_zone(binary_sensor::BinarySensor *sensor, uint16_t min_distance, uint16_t max_distance,
+                uint16_t hysteresis, uint32_t enter_delay, uint32_t exit_delay) {
+    this->zones_.push_back({sensor, min_distance, max_distance, hysteresis, enter_delay, exit_delay, 0, false, false});
+  }
+#endif
 #ifdef USE_BUTTON
   void cal_start();
   void factory_reset();
@@ -185,26 +324,73 @@ class LD2410SComponent final : public Component, public uart::UARTDevice {
 #endif
 #ifdef USE_SENSOR
   void set_gate_energy_sensor(uint8_t gate, sensor::Sensor *s) { this->gate_energy_sensor_[gate].set_sensor(s); }
+  void set_gate_energy_window(uint32_t window) { this->gate_energy_window_ = window; }
+  void enable_link_stats() { this->link_stats_ = true; }
+  void set_distance_filter(DistanceFilterType type, uint8_t window_size, float alpha, float beta, uint16_t deadband) {
+    this->distance_filter_.set_type(type);
+    this->distance_filter_.set_window_size(window_size);
+    this->distance_filter_.set_alpha(alpha);
+    this->distance_filter_.set_beta(beta);
+    this->distance_filter_.set_deadband(deadband);
+  }
+  void set_gate_energy_aggregation(GateEnergyAggregation aggregation) { this->gate_energy_aggregation_ = aggregation; }
 #endif
 #ifdef USE_SWITCH
   void set_minimal_output(bool state);
 #endif
+  void set_stats_interval(uint32_t stats_interval) { this->stats_interval_ = stats_interval; }
+  void set_rx_poll_interval(uint32_t rx_poll_interval) { this->rx_poll_interval_ = rx_poll_interval; }
+  void set_noise_stats(bool noise_stats) { this->noise_stats_enabled_ = noise_stats; }
+  // noise statistics actions
+  void suggest_thresholds(uint8_t trigger_margin, uint8_t hold_margin);
+  void apply_suggested_thresholds(uint8_t trigger_margin, uint8_t hold_margin);
+  void reset_noise_stats();
+  void set_history_size(uint16_t history_size) { this->history_size_ = history_size; }
+  void dump_history();
+  void set_restore_config(const std::string &key) {
+    this->restore_config_ = true;
+    this->config_key_ = fnv1a_hash(key);
+  }
 
  protected:
+  void schedule_command_(uint16_t command, uint16_t sub_command = NO_SUB_CMD);
   void send_();
   void build_cmd_frame_(uint16_t command, uint16_t sub_command = NO_SUB_CMD);
-  void sending_pause_();
+  void sending_pause_(uint32_t pause = TX_PAUSE_TIMEOUT);
 
   bool receive_();
   void parse_();
   void parse_short_data_frame_();
   void parse_data_frame_();
   void parse_cmd_frame_();
+  void update_stats_();
 
   void read_all_();
   void read_all_thresholds_();
 
+  ConfigShadowT get_config_shadow_();
+  bool restore_config_shadow_();
+  void schedule_config_save_();
+  void save_config_shadow_();
+  void verify_config_shadow_();
+  void publish_config_();
+  void publish_fw_version_();
+
   void parse_data_energy_values_read_(uint8_t *data);
+  void publish_target_distance_();
+#ifdef USE_BINARY_SENSOR
+  void update_zones_();
+#endif
+  void update_noise_stats_(uint8_t gate, uint8_t db);
+  void record_history_(bool has_energy);
+  void dump_history_chunk_();
+  uint16_t history_index_(uint16_t oldest, uint16_t pos) const { return (oldest + pos) % this->history_size_; }
+  bool suggest_gate_thresholds_(uint8_t gate, uint8_t trigger_margin, uint8_t hold_margin, uint32_t &trigger,
+                                uint32_t &hold);
+#ifdef USE_SENSOR
+  void publish_gate_energy_window_();
+  void reset_gate_energy_window_();
+#endif
 
   void parse_ack_config_start_(const uint8_t *data);
   void parse_ack_config_end_(const uint8_t *data);
@@ -216,8 +402,13 @@ class LD2410SComponent final : public Component, public uart::UARTDevice {
 
   LD2410Sschedule tx_schedule_;
   LD2410Srx rx_;
+#ifdef USE_SENSOR
+  LD2410SDistanceFilter distance_filter_;
+#endif
 
-  uint8_t tx_frame_[RX_TX_BUFFER_SIZE] = {};
+  // shared by all instances, frames are built right before they are written
+  inline static uint8_t tx_frame_[RX_TX_BUFFER_SIZE] = {};
+  inline static uint16_t tx_frame_size_{0};
 
   // settings_;
   uint8_t gate_energy_[16] = {};
@@ -225,7 +416,6 @@ class LD2410SComponent final : public Component, public uart::UARTDevice {
   uint16_t version_[3] = {0, 0, 0};
   uint16_t target_distance_{0};
   uint16_t cal_progress_{0};
-  uint16_t tx_frame_size_{0};
   uint32_t gate_trig_threshold_[16] = {};
   uint32_t gate_hold_threshold_[16] = {};
   uint32_t max_detect_gate_{0};
@@ -235,17 +425,51 @@ class LD2410SComponent final : public Component, public uart::UARTDevice {
   uint32_t distance_reporting_freq_{0};
   uint32_t resp_speed_{5};
   uint32_t loop_count_{0};
+  uint32_t stats_interval_{0};  // 0 disables the periodic parser statistics
+  uint32_t stats_start_{0};
+  uint32_t rx_time_us_{0};
+  uint32_t rx_poll_interval_{0};  // 0 keeps the loop running, otherwise idle loop is disabled and uart is polled
+  uint32_t config_key_{0};
+  uint32_t config_saved_hash_{0};
+  uint32_t config_restored_hash_{0};  // restored config, compared once the radar config has been read
+  uint8_t verify_reads_{0};           // config reads still to come before the restored config is compared
+  ESPPreferenceObject config_pref_;
+  std::unique_ptr<GateNoiseStatsT[]> noise_stats_;  // allocated only when enabled
+  bool noise_stats_enabled_{false};
+  std::unique_ptr<HistoryRecordT[]> history_;  // ring of the last history_size_ frames, allocated only when enabled
+  uint16_t history_size_{0};
+  uint16_t history_head_{0};  // next record to write
+  uint16_t history_count_{0};
+  uint32_t history_last_time_{0};
+  uint32_t history_written_{0};       // records written since boot
+  uint32_t history_dump_age_{0};      // age of the next record to log
+  uint32_t history_dump_written_{0};  // history_written_ when the dump started
+  uint16_t history_dump_oldest_{0};   // oldest record when the dump started
+  uint16_t history_dump_count_{0};    // records to log, 0 while no dump runs
+  uint16_t history_dump_pos_{0};      // next record to log, counted from history_dump_oldest_
+  bool log_stats_{false};
+  bool link_stats_{false};
+  bool restore_config_{false};
   bool cal_running_{false};
   bool pause_tx_{false};
   bool minimal_output_{true};
   bool init_done_{false};
 
+#ifdef USE_BINARY_SENSOR
+  std::vector<ZoneT> zones_;
+#endif
 #ifdef USE_NUMBER
   std::array<number::Number *, TOTAL_GATES> gate_trig_threshold_number_{};
   std::array<number::Number *, TOTAL_GATES> gate_hold_threshold_number_{};
 #endif
 #ifdef USE_SENSOR
   std::array<SensorWithDedup<uint8_t>, TOTAL_GATES> gate_energy_sensor_{};
+  // aggregation window, 0 publishes every frame
+  uint32_t gate_energy_window_{0};
+  uint32_t gate_energy_sum_[TOTAL_GATES] = {};
+  uint32_t gate_energy_count_{0};
+  uint8_t gate_energy_max_[TOTAL_GATES] = {};
+  GateEnergyAggregation gate_energy_aggregation_{GateEnergyAggregation::LAST};
 #endif
 
   // append variable sized append_data to data, returns true if not overflow
@@ -2,26 +2,83 @@ import esphome.codegen as cg
 from esphome.components import sensor
 import esphome.config_validation as cv
 from esphome.const import (
+    CONF_ALPHA,
     CONF_ID,
+    CONF_TYPE,
+    CONF_WINDOW_SIZE,
     DEVICE_CLASS_DISTANCE,
     ENTITY_CATEGORY_DIAGNOSTIC,
     ICON_MOTION_SENSOR,
+    STATE_CLASS_MEASUREMENT,
     UNIT_CENTIMETER,
     UNIT_DECIBEL,
+    UNIT_MILLISECOND,
     UNIT_PERCENT,
 )
 
-from . import CONF_LD2410S_ID, LD2410SComponent
+from . import CONF_LD2410S_ID, LD2410SComponent, ld2410s_ns
 
 DEPENDENCIES = ["ld2410s"]
 
+CONF_ACK_LATENCY = "ack_latency"
+CONF_BETA = "beta"
+CONF_BUFFER_OVERFLOWS = "buffer_overflows"
 CONF_CAL_PROGRESS = "cal_progress"
+CONF_COMMAND_RESTARTS = "command_restarts"
+CONF_COMMAND_RETRIES = "command_retries"
+CONF_DEADBAND = "deadband"
+CONF_DISTANCE_FILTER = "distance_filter"
+CONF_FRAME_RATE = "frame_rate"
+CONF_GATE_ENERGY_AGGREGATION = "gate_energy_aggregation"
+CONF_GATE_ENERGY_WINDOW = "gate_energy_window"
+CONF_RESYNC_BYTES = "resync_bytes"
 CONF_TARGET_DISTANCE = "target_distance"
 
+DistanceFilterType = ld2410s_ns.enum("DistanceFilterType", is_class=True)
+DISTANCE_FILTER_TYPES = {
+    "MEDIAN": DistanceFilterType.MEDIAN,
+    "EMA": DistanceFilterType.EMA,
+    "ALPHA_BETA": DistanceFilterType.ALPHA_BETA,
+}
+
+DISTANCE_FILTER_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_TYPE): cv.enum(DISTANCE_FILTER_TYPES, upper=True),
+        cv.Optional(CONF_WINDOW_SIZE, default=5): cv.int_range(min=3, max=9),
+        cv.Optional(CONF_ALPHA, default=0.3): cv.float_range(min=0.01, max=1.0),
+        cv.Optional(CONF_BETA, default=0.05): cv.float_range(min=0.0, max=1.0),
+        cv.Optional(CONF_DEADBAND, default="0cm"): cv.All(
+            cv.distance, cv.Range(min=0.0, max=1.0)
+        ),
+    }
+)
+
+# link health sensors, counters are per stats window
+LINK_STATS_SENSORS = {
+    CONF_FRAME_RATE: ("set_frame_rate_sensor", "frames/s", "mdi:swap-horizontal", 2),
+    CONF_RESYNC_BYTES: ("set_resync_bytes_sensor", "B", "mdi:content-cut", 0),
+    CONF_BUFFER_OVERFLOWS: ("set_buffer_overflows_sensor", None, "mdi:tray-full", 0),
+    CONF_COMMAND_RETRIES: ("set_command_retries_sensor", None, "mdi:replay", 0),
+    CONF_COMMAND_RESTARTS: ("set_command_restarts_sensor", None, "mdi:restart", 0),
+    CONF_ACK_LATENCY: ("set_ack_latency_sensor", UNIT_MILLISECOND, "mdi:timer-sand", 0),
+}
+
+GateEnergyAggregation = ld2410s_ns.enum("GateEnergyAggregation", is_class=True)
+GATE_ENERGY_AGGREGATIONS = {
+    "LAST": GateEnergyAggregation.LAST,
+    "MAX": GateEnergyAggregation.MAX,
+    "MEAN": GateEnergyAggregation.MEAN,
+}
+
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(CONF_ID): cv.declare_id(cg.EntityBase),
         cv.GenerateID(CONF_LD2410S_ID): cv.use_id(LD2410SComponent),
+        cv.Optional(CONF_DISTANCE_FILTER): DISTANCE_FILTER_SCHEMA,
+        cv.Optional(CONF_GATE_ENERGY_WINDOW): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_GATE_ENERGY_AGGREGATION, default="LAST"): cv.enum(
+            GATE_ENERGY_AGGREGATIONS, upper=True
+        ),
         cv.Optional(CONF_CAL_PROGRESS): sensor.sensor_schema(
             entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
             unit_of_measurement=UNIT_PERCENT,
@@ -44,6 +101,19 @@ CONFIG_SCHEMA = cv.Schema(
     }
 )
 
+CONFIG_SCHEMA = CONFIG_SCHEMA.extend(
+    {
+        cv.Optional(key): sensor.sensor_schema(
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            state_class=STATE_CLASS_MEASUREMENT,
+            icon=icon,
+            accuracy_decimals=accuracy,
+            **({"unit_of_measurement": unit} if unit else {}),
+        )
+        for key, (_, unit, icon, accuracy) in LINK_STATS_SENSORS.items()
+    }
+)
+
 CONFIG_SCHEMA = CONFIG_SCHEMA.extend(
     {
         cv.Optional(f"g{x}_energy"): sensor.sensor_schema(
@@ -73,7 +143,29 @@ async def to_code(config):
     if target_distance_config := config.get(CONF_TARGET_DISTANCE):
         sens = await sensor.new_sensor(target_distance_config)
         cg.add(ld2410s_component.set_target_distance_sensor(sens))
+    if filter_config := config.get(CONF_DISTANCE_FILTER):
+        cg.add(
+            ld2410s_component.set_distance_filter(
+                filter_config[CONF_TYPE],
+                filter_config[CONF_WINDOW_SIZE],
+                filter_config[CONF_ALPHA],
+                filter_config[CONF_BETA],
+                round(filter_config[CONF_DEADBAND] * 100),
+            )
+        )
     for x in range(16):
         if energy_config := config.get(f"g{x}_energy"):
             sens = await sensor.new_sensor(energy_config)
             cg.add(ld2410s_component.set_gate_energy_sensor(x, sens))
+    for key, (setter, _, _, _) in LINK_STATS_SENSORS.items():
+        if link_config := config.get(key):
+            sens = await sensor.new_sensor(link_config)
+            cg.add(getattr(ld2410s_component, setter)(sens))
+            cg.add(ld2410s_component.enable_link_stats())
+    if gate_energy_window := config.get(CONF_GATE_ENERGY_WINDOW):
+        cg.add(ld2410s_component.set_gate_energy_window(gate_energy_window))
+        cg.add(
+            ld2410s_component.set_gate_energy_aggregation(
+                config[CONF_GATE_ENERGY_AGGREGATION]
+            )
+        )
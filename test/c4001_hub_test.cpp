@@ -0,0 +1,439 @@
+// Host test for the C4001 hub, the ESPHome headers come from test/stubs:
+//   g++ -std=gnu++20 -O2 -Wall -Wno-unknown-pragmas -Itest/stubs -Icomponents -o c4001_hub_test
+//     test/c4001_hub_test.cpp components/dfrobot_c4001/*.cpp components/dfrobot_c4001/*/*.cpp
+//   ./c4001_hub_test
+// Drives DFRobotC4001Hub, its command queue and every command against a scripted module CLI at 9600 baud:
+// boot, restart, config_save, mode switch and factory reset, with an injected Error and a sensorStop the module
+// ignores. Checks the command transcript of each step, the retries and the published config_save_time.
+
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "dfrobot_c4001/button/button.h"
+#include "dfrobot_c4001/dfrobot_c4001.h"
+#include "dfrobot_c4001/number/number.h"
+#include "dfrobot_c4001/select/select.h"
+#include "dfrobot_c4001/switch/switch.h"
+
+namespace esphome {
+static ESPPreferences preferences;
+ESPPreferences *global_preferences = &preferences;  // NOLINT
+
+static uint32_t now_ms = 0;  // simulated clock, advanced one ms per loop pass
+uint32_t millis() { return now_ms; }
+uint32_t micros() { return now_ms * 1000; }
+}  // namespace esphome
+
+using esphome::dfrobot_c4001::DFRobotC4001Hub;
+using esphome::dfrobot_c4001::MODE_PRESENCE;
+using esphome::dfrobot_c4001::MODE_SPEED_AND_DISTANCE;
+using esphome::dfrobot_c4001::MODEL_SEN0609;
+using esphome::sensor::Sensor;
+using esphome::text_sensor::TextSensor;
+using Transcript = std::vector<std::string>;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      failures++; \
+    } \
+  } while (0)
+
+static const char *const PROMPT = "DFRobot:/>";
+static const uint32_t LATENCY_MS = 20;          // until the module answers a command
+static const uint32_t REPORT_INTERVAL_MS = 125;  // between reports while the sensor is started
+static const uint32_t DRAIN_TIMEOUT_MS = 30000;
+
+// commands the module only accepts while the sensor is stopped
+static const char *const NEEDS_STOP[] = {"setRange",      "setTrigRange", "setSensitivity", "setLatency",
+                                         "setInhibit",    "setThrFactor", "setMicroMotion", "setGpioMode",
+                                         "setUartOutput", "setRunApp",    "saveConfig",     "resetCfg"};
+// every command the hub can send
+static const std::set<std::string> ALL_COMMANDS = {
+    "sensorStart", "sensorStop", "resetSystem", "resetCfg", "saveConfig", "setRunApp", "setUartOutput",
+    "setLedMode", "getGpioMode", "setGpioMode", "getHWV", "getSWV", "getRange", "setRange", "getTrigRange",
+    "setTrigRange", "getSensitivity", "setSensitivity", "getLatency", "setLatency", "getInhibit", "setInhibit",
+    "getThrFactor", "setThrFactor", "getMicroMotion", "setMicroMotion"};
+// parameters after resetCfg, as the getters answer them
+static const std::map<std::string, std::string> DEFAULTS = {
+    {"Range", "0.6 25.0"}, {"TrigRange", "6.0"}, {"Sensitivity", "7 5"}, {"Latency", "0.05 15.0"},
+    {"Inhibit", "1.0"},    {"ThrFactor", "5"},   {"MicroMotion", "0"},   {"GpioMode", "1 1"}};
+
+static std::vector<std::string> split(const std::string &line) {
+  std::vector<std::string> words;
+  size_t pos = 0;
+  while (pos < line.size()) {
+    size_t end = line.find(' ', pos);
+    if (end == std::string::npos)
+      end = line.size();
+    if (end > pos)
+      words.push_back(line.substr(pos, end - pos));
+    pos = end + 1;
+  }
+  return words;
+}
+
+// the module side of the UART, echoes each command line and answers it like the C4001 CLI
+class SimulatedModule {
+ public:
+  // answers all complete command lines written by the hub
+  void receive(const std::vector<uint8_t> &tx) {
+    for (uint8_t byte : tx) {
+      if (byte == '\r')
+        continue;
+      if (byte != '\n') {
+        this->line_ += static_cast<char>(byte);
+        continue;
+      }
+      if (!this->line_.empty()) {
+        this->commands.push_back(this->line_);
+        this->sent.insert(split(this->line_)[0]);
+        this->answers_.push_back({esphome::now_ms + LATENCY_MS, this->answer_(this->line_)});
+      }
+      this->line_.clear();
+    }
+  }
+  // queues the answers and reports that are due, then moves what the UART carries in one ms to the hub
+  void transfer(esphome::uart::UARTDevice &uart) {
+    while (!this->answers_.empty() && this->answers_.front().due <= esphome::now_ms) {
+      this->rx_.insert(this->rx_.end(), this->answers_.front().text.begin(), this->answers_.front().text.end());
+      this->answers_.pop_front();
+    }
+    if (this->started && esphome::now_ms % REPORT_INTERVAL_MS == 0) {
+      std::string report = this->report_() + "\r\n";
+      this->rx_.insert(this->rx_.end(), report.begin(), report.end());
+    }
+    if (!this->rx_.empty()) {
+      uint8_t byte = this->rx_.front();
+      this->rx_.pop_front();
+      uart.inject_rx(&byte, 1);
+    }
+  }
+
+  std::string get(const std::string &name) const { return this->params_.at(name); }
+
+  Transcript commands;         // cleared by each test
+  std::set<std::string> sent;  // names of all commands received
+  std::string error_once;      // the next command with this name is answered with Error
+  uint32_t stop_ignored{0};    // sensorStop commands answered with Done while the sensor keeps running
+  bool started{true};
+  int mode{0};
+
+ protected:
+  struct Answer {
+    uint32_t due;
+    std::string text;
+  };
+
+  std::string answer_(const std::string &line) {
+    std::vector<std::string> words = split(line);
+    const std::string &name = words[0];
+    if (name == "resetSystem") {
+      // the module restarts and answers with nothing, not even an echo
+      this->started = true;
+      return "";
+    }
+    std::vector<std::string> out = {line};
+    if (name == this->error_once) {
+      this->error_once.clear();
+      out.push_back("Error");
+      return this->lines_(out);
+    }
+    bool needs_stop = false;
+    for (const char *command : NEEDS_STOP)
+      needs_stop |= name == command;
+    if (this->started && needs_stop) {
+      out.push_back("sensor is not stopped");
+      out.push_back("Error");
+      return this->lines_(out);
+    }
+    if (name == "sensorStart") {
+      this->started = true;
+    } else if (name == "sensorStop") {
+      if (this->stop_ignored > 0) {
+        this->stop_ignored--;
+      } else {
+        this->started = false;
+      }
+    } else if (name == "setRunApp") {
+      this->mode = std::stoi(words[1]);
+    } else if (name == "getSWV") {
+      out.push_back("SoftwareVersion:V1.0.0_SIM");
+    } else if (name == "getHWV") {
+      out.push_back("HardwareVersion:JYSJ_428_SIM");
+    } else if (name == "setGpioMode") {
+      this->params_["GpioMode"] = words[1] + " " + words[2];
+      this->changed_ = true;
+    } else if (name.compare(0, 3, "get") == 0) {
+      out.push_back("Response " + this->params_.at(name.substr(3)));
+    } else if (name == "saveConfig") {
+      if (!this->changed_)
+        out.push_back("no parameter has changed");
+      this->changed_ = false;
+    } else if (name == "resetCfg") {
+      this->params_ = DEFAULTS;
+    } else if (name != "setLedMode" && name != "setUartOutput") {
+      // the other setters store their arguments as the getters answer them
+      std::string value;
+      for (size_t i = 1; i < words.size(); i++)
+        value += (i > 1 ? " " : "") + words[i];
+      this->params_.at(name.substr(3)) = value;
+      this->changed_ = true;
+    }
+    out.push_back("Done");
+    return this->lines_(out);
+  }
+  std::string lines_(const std::vector<std::string> &out) const {
+    std::string text;
+    for (const std::string &line : out)
+      text += line + "\r\n";
+    return text + PROMPT;
+  }
+  // one target walking away in SPEED_AND_DISTANCE mode, always present in PRESENCE mode
+  std::string report_() const {
+    char report[64];
+    if (this->mode == 0)
+      return "$DFHPD,1, , ,*";
+    snprintf(report, sizeof(report), "$DFDMD,1,0,%.3f,0.500,1000,0.000,0.000*", 2.0 + esphome::now_ms % 4000 / 1000.0);
+    return report;
+  }
+
+  std::string line_;
+  std::deque<Answer> answers_;
+  std::deque<uint8_t> rx_;
+  std::map<std::string, std::string> params_{DEFAULTS};
+  bool changed_{false};
+};
+
+// the hub with all of its entities, wired up the way the code generator does it
+struct Device {
+  Device() {
+    for (esphome::Parented<DFRobotC4001Hub> *entity : std::initializer_list<esphome::Parented<DFRobotC4001Hub> *>{
+             &max_range, &min_range, &trigger_range, &hold_sensitivity, &trigger_sensitivity, &on_latency,
+             &off_latency, &inhibit_time, &threshold_factor, &config_save, &factory_reset, &restart, &mode,
+             &out_led, &run_led, &micro_motion})
+      entity->set_parent(&hub);
+    hub.set_max_range_number(&max_range);
+    hub.set_min_range_number(&min_range);
+    hub.set_trigger_range_number(&trigger_range);
+    hub.set_hold_sensitivity_number(&hold_sensitivity);
+    hub.set_trigger_sensitivity_number(&trigger_sensitivity);
+    hub.set_on_latency_number(&on_latency);
+    hub.set_off_latency_number(&off_latency);
+    hub.set_inhibit_time_number(&inhibit_time);
+    hub.set_threshold_factor_number(&threshold_factor);
+    hub.set_config_save_button(&config_save);
+    hub.set_factory_reset_button(&factory_reset);
+    hub.set_restart_button(&restart);
+    hub.set_mode_select(&mode);
+    hub.set_out_led_enable_switch(&out_led);
+    hub.set_run_led_enable_switch(&run_led);
+    hub.set_micro_motion_enable_switch(&micro_motion);
+    hub.set_startup_time_sensor(&startup_time);
+    hub.set_config_save_time_sensor(&config_save_time);
+    hub.set_command_retries_sensor(&command_retries);
+    hub.set_target_distance_sensor(&target_distance);
+    hub.set_software_version_text_sensor(&software_version);
+    hub.set_hardware_version_text_sensor(&hardware_version);
+    hub.set_model(MODEL_SEN0609);
+    hub.set_mode(MODE_PRESENCE);
+  }
+
+  DFRobotC4001Hub hub;
+  esphome::dfrobot_c4001::MaxRangeNumber max_range;
+  esphome::dfrobot_c4001::MinRangeNumber min_range;
+  esphome::dfrobot_c4001::TriggerRangeNumber trigger_range;
+  esphome::dfrobot_c4001::HoldSensitivityNumber hold_sensitivity;
+  esphome::dfrobot_c4001::TriggerSensitivityNumber trigger_sensitivity;
+  esphome::dfrobot_c4001::OnLatencyNumber on_latency;
+  esphome::dfrobot_c4001::OffLatencyNumber off_latency;
+  esphome::dfrobot_c4001::InhibitTimeNumber inhibit_time;
+  esphome::dfrobot_c4001::ThresholdFactorNumber threshold_factor;
+  esphome::dfrobot_c4001::ConfigSaveButton config_save;
+  esphome::dfrobot_c4001::FactoryResetButton factory_reset;
+  esphome::dfrobot_c4001::RestartButton restart;
+  esphome::dfrobot_c4001::ModeSelect mode;
+  esphome::dfrobot_c4001::OutLedSwitch out_led;
+  esphome::dfrobot_c4001::RunLedSwitch run_led;
+  esphome::dfrobot_c4001::MicroMotionSwitch micro_motion;
+  Sensor startup_time;
+  Sensor config_save_time;
+  Sensor command_retries;
+  Sensor target_distance;
+  TextSensor software_version;
+  TextSensor hardware_version;
+  SimulatedModule module;
+};
+
+// one simulated ms: timers, UART transfer, loop pass and the module reading what the hub wrote
+static void step(Device &device) {
+  esphome::now_ms++;
+  device.hub.run_timers();
+  device.module.transfer(device.hub);
+  if (device.hub.is_loop_enabled())
+    device.hub.loop();
+  device.module.receive(device.hub.take_tx());
+}
+
+// runs until the command queue drains, the hub publishes command_retries every time it does
+static uint32_t run_until_drained(Device &device) {
+  uint32_t drains = device.command_retries.publish_count;
+  uint32_t start = esphome::now_ms;
+  while (device.command_retries.publish_count == drains && esphome::now_ms - start < DRAIN_TIMEOUT_MS)
+    step(device);
+  CHECK(device.command_retries.publish_count == drains + 1);
+  return esphome::now_ms;
+}
+
+static void run_for(Device &device, uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++)
+    step(device);
+}
+
+// prints the transcript of a failed step
+static bool transcript_is(const Transcript &commands, const Transcript &expected) {
+  if (commands == expected)
+    return true;
+  printf("  transcript:");
+  for (const std::string &command : commands)
+    printf(" '%s'", command.c_str());
+  printf("\n");
+  return false;
+}
+
+static void test_boot(Device &device) {
+  device.hub.setup();
+  run_until_drained(device);
+  CHECK(transcript_is(device.module.commands,
+                      {"resetSystem", "sensorStop", "setRunApp 0", "setLedMode 1 1", "setUartOutput 1 1 1 1.0",
+                       "sensorStart", "getHWV", "getSWV", "getGpioMode 1", "getRange", "getTrigRange",
+                       "getSensitivity", "getLatency", "getInhibit"}));
+  CHECK(device.hardware_version.state == "JYSJ_428_SIM");
+  CHECK(device.software_version.state == "V1.0.0_SIM");
+  CHECK(device.max_range.state == 25.0f);
+  CHECK(device.hold_sensitivity.state == 7.0f);
+  CHECK(device.off_latency.state == 15.0f);
+  CHECK(device.out_led.state);
+  CHECK(device.command_retries.state == 0);
+  CHECK(device.config_save_time.publish_count == 0);
+  // the first report after the queue drained is the startup time
+  run_for(device, REPORT_INTERVAL_MS);
+  CHECK(device.startup_time.publish_count == 1);
+  CHECK(device.startup_time.state > 0);
+}
+
+// an Error is retried, resetSystem without an answer completes on the next line and reloads the config
+static void test_restart(Device &device) {
+  device.module.commands.clear();
+  device.module.error_once = "getRange";
+  device.restart.press();
+  run_until_drained(device);
+  CHECK(transcript_is(device.module.commands,
+                      {"sensorStop", "resetSystem", "getHWV", "getSWV", "getGpioMode 1", "getRange", "getRange",
+                       "getTrigRange", "getSensitivity", "getLatency", "getInhibit"}));
+  CHECK(device.command_retries.state == 1);
+  CHECK(device.max_range.state == 25.0f);
+}
+
+// the module keeps running after the first sensorStop, the set command it refuses is sent again after another stop
+static void test_config_save(Device &device) {
+  device.module.commands.clear();
+  device.module.stop_ignored = 1;
+  device.max_range.make_call().set_value(10.0f).perform();
+  device.trigger_range.make_call().set_value(4.0f).perform();
+  device.hold_sensitivity.make_call().set_value(3.0f).perform();
+  device.on_latency.make_call().set_value(0.1f).perform();
+  device.inhibit_time.make_call().set_value(2.0f).perform();
+  device.out_led.turn_off();
+  device.run_led.turn_on();
+  uint32_t start = esphome::now_ms;
+  device.config_save.press();
+  uint32_t drained = run_until_drained(device);
+  CHECK(transcript_is(device.module.commands,
+                      {"sensorStop", "setLedMode 1 0", "setGpioMode 1 2", "sensorStop", "setGpioMode 1 2",
+                       "setRange 0.600 10.000", "setTrigRange 4.000", "setSensitivity 3 5",
+                       "setLatency 0.100 15.000", "setInhibit 2.000", "saveConfig", "resetSystem", "sensorStart"}));
+  CHECK(device.command_retries.state == 2);
+  CHECK(device.config_save_time.publish_count == 1);
+  CHECK(device.config_save_time.state == drained - start);
+  // every command waits at least for the module latency
+  CHECK(device.config_save_time.state > LATENCY_MS * device.module.commands.size());
+  CHECK(device.module.get("Range") == "0.600 10.000");
+  CHECK(device.module.get("Sensitivity") == "3 5");
+  CHECK(device.module.get("GpioMode") == "1 2");
+  CHECK(device.module.started);
+  printf("  config_save: %zu commands in %.0f ms\n", device.module.commands.size(), device.config_save_time.state);
+}
+
+// the parameters of the new mode are read after the switch, targets are reported
+static void test_mode_switch(Device &device) {
+  device.module.commands.clear();
+  device.mode.make_call().set_index(MODE_SPEED_AND_DISTANCE).perform();
+  run_until_drained(device);
+  CHECK(transcript_is(device.module.commands, {"sensorStop", "setRunApp 1", "sensorStart", "getRange",
+                                               "getThrFactor", "getMicroMotion"}));
+  CHECK(device.hub.get_mode() == MODE_SPEED_AND_DISTANCE);
+  CHECK(device.mode.index == MODE_SPEED_AND_DISTANCE);
+  CHECK(device.module.mode == 1);
+  CHECK(device.max_range.state == 10.0f);
+  run_for(device, 2 * REPORT_INTERVAL_MS);
+  CHECK(device.target_distance.publish_count > 0);
+  CHECK(device.target_distance.state >= 2.0f);
+
+  // the parameters of this mode are saved the same way
+  device.module.commands.clear();
+  device.threshold_factor.make_call().set_value(8.0f).perform();
+  device.micro_motion.turn_on();
+  device.config_save.press();
+  run_until_drained(device);
+  CHECK(transcript_is(device.module.commands, {"sensorStop", "setThrFactor 8.000", "setMicroMotion 1", "saveConfig",
+                                               "resetSystem", "sensorStart"}));
+  CHECK(device.config_save_time.publish_count == 2);
+  CHECK(device.module.get("ThrFactor") == "8.000");
+  CHECK(device.module.get("MicroMotion") == "1");
+}
+
+// resetCfg restores the module defaults, the hub sets the module up again and reads them back
+static void test_factory_reset(Device &device) {
+  device.module.commands.clear();
+  device.factory_reset.press();
+  run_until_drained(device);
+  CHECK(transcript_is(device.module.commands,
+                      {"sensorStop", "resetCfg", "sensorStop", "setRunApp 1", "setLedMode 1 0", "sensorStart",
+                       "getHWV", "getSWV", "getGpioMode 1", "getRange", "getThrFactor", "getMicroMotion"}));
+  CHECK(device.max_range.state == 25.0f);
+  CHECK(device.threshold_factor.state == 5.0f);
+  CHECK(!device.micro_motion.state);
+  CHECK(device.out_led.state);
+  CHECK(device.run_led.state);
+  CHECK(device.command_retries.state == 2);
+}
+
+int main() {
+  Device device;
+  test_boot(device);
+  test_restart(device);
+  test_config_save(device);
+  test_mode_switch(device);
+  test_factory_reset(device);
+  CHECK(!device.hub.is_failed());
+  for (const std::string &command : ALL_COMMANDS) {
+    if (device.module.sent.count(command) == 0)
+      printf("  never sent: %s\n", command.c_str());
+  }
+  CHECK(device.module.sent == ALL_COMMANDS);
+
+  if (failures > 0) {
+    printf("c4001_hub_test: %d checks failed\n", failures);
+    return 1;
+  }
+  printf("c4001_hub_test: passed\n");
+  return 0;
+}
@@ -0,0 +1,108 @@
+// Host test for the C4001 command queue deque, no ESPHome needed:
+//   g++ -std=c++17 -Wall -Icomponents test/fixed_deque_test.cpp -o fixed_deque_test && ./fixed_deque_test
+
+#include <cstdio>
+
+#include "dfrobot_c4001/fixed_deque.h"
+
+using esphome::dfrobot_c4001::FixedDeque;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      failures++; \
+    } \
+  } while (0)
+
+static void test_empty() {
+  FixedDeque<int, 4> deque;
+  CHECK(deque.empty());
+  CHECK(!deque.full());
+  CHECK(deque.size() == 0);
+  CHECK(deque.capacity() == 4);
+  // popping an empty deque is a no-op
+  deque.pop_front();
+  deque.pop_back();
+  CHECK(deque.empty());
+  CHECK(deque.push_back(1));
+  CHECK(deque.size() == 1);
+  CHECK(deque.front() == 1);
+  CHECK(deque.back() == 1);
+}
+
+static void test_push_front_at_head_zero() {
+  // a capacity that is not a power of two catches an unsigned wrap of the head
+  FixedDeque<int, 3> deque;
+  // head is 0, push_front has to step back to the last slot
+  CHECK(deque.push_front(1));
+  CHECK(deque.front() == 1);
+  CHECK(deque.back() == 1);
+  CHECK(deque.push_front(2));
+  CHECK(deque.push_back(3));
+  CHECK(deque.size() == 3);
+  CHECK(deque[0] == 2);
+  CHECK(deque[1] == 1);
+  CHECK(deque[2] == 3);
+  CHECK(deque.front() == 2);
+  CHECK(deque.back() == 3);
+}
+
+static void test_wrap_around() {
+  FixedDeque<int, 3> deque;
+  int next = 0;
+  int expected = 0;
+  // move the head around the ring several times
+  for (int round = 0; round < 10; round++) {
+    while (!deque.full())
+      CHECK(deque.push_back(next++));
+    CHECK(deque.size() == 3);
+    CHECK(deque.front() == expected);
+    CHECK(deque.back() == next - 1);
+    for (size_t i = 0; i < deque.size(); i++)
+      CHECK(deque[i] == expected + static_cast<int>(i));
+    deque.pop_front();
+    deque.pop_front();
+    expected += 2;
+    CHECK(deque.size() == 1);
+    CHECK(deque.front() == expected);
+  }
+  deque.pop_back();
+  CHECK(deque.empty());
+}
+
+static void test_full() {
+  FixedDeque<int, 2> deque;
+  CHECK(deque.push_back(1));
+  CHECK(deque.push_front(0));
+  CHECK(deque.full());
+  // a full deque rejects both ends and keeps its content
+  CHECK(!deque.push_back(2));
+  CHECK(!deque.push_front(-1));
+  CHECK(deque.size() == 2);
+  CHECK(deque.front() == 0);
+  CHECK(deque.back() == 1);
+  deque.pop_back();
+  CHECK(!deque.full());
+  CHECK(deque.push_back(3));
+  CHECK(deque.back() == 3);
+  deque.clear();
+  CHECK(deque.empty());
+  CHECK(deque.push_front(4));
+  CHECK(deque.front() == 4);
+}
+
+int main() {
+  test_empty();
+  test_push_front_at_head_zero();
+  test_wrap_around();
+  test_full();
+  if (failures > 0) {
+    printf("fixed_deque_test: %d checks failed\n", failures);
+    return 1;
+  }
+  printf("fixed_deque_test: passed\n");
+  return 0;
+}
@@ -0,0 +1,47 @@
+"""Writes ld2410s-capture.bin, the LD2410S byte stream replayed by ld2410s_replay_test.cpp.
+
+The stream is generated so that it is identical on every run: two command ACKs,
+then a target walking away and back reported with short frames, a standard frame
+with gate energies every 5th frame, and a few stray bytes that force a resync.
+"""
+
+import math
+from pathlib import Path
+import struct
+
+SHORT_HEADER, SHORT_FOOTER = b"\x6e", b"\x62"
+STD_HEADER, STD_FOOTER = b"\xf4\xf3\xf2\xf1", b"\xf8\xf7\xf6\xf5"
+CMD_HEADER, CMD_FOOTER = b"\xfd\xfc\xfb\xfa", b"\x04\x03\x02\x01"
+FRAMES = 400
+
+
+def framed(header, payload, footer):
+    return header + struct.pack("<H", len(payload)) + payload + footer
+
+
+def ack(command, extra=b""):
+    return framed(CMD_HEADER, struct.pack("<HH", command | 0x0100, 0) + extra, CMD_FOOTER)
+
+
+def main():
+    out = bytearray()
+    # config mode start (protocol version 1, buffer size 64) and end
+    out += ack(0x00FF, struct.pack("<HH", 1, 64))
+    out += ack(0x00FE)
+    for i in range(FRAMES):
+        present = i % 100 < 80
+        state = 3 if present else 0
+        distance = int(150 + 120 * math.sin(i / 20)) if present else 0
+        if i % 5 == 0:
+            energies = [int(40 + 400 * math.exp(-abs(gate - distance / 70))) for gate in range(16)]
+            payload = struct.pack("<BBHH", 0x01, state, distance, 0) + struct.pack("<16I", *energies)
+            out += framed(STD_HEADER, payload, STD_FOOTER)
+        else:
+            out += SHORT_HEADER + struct.pack("<BH", state, distance) + SHORT_FOOTER
+        if i % 97 == 0:
+            out += b"\x00\x55"  # line noise
+    Path(__file__).with_name("ld2410s-capture.bin").write_bytes(bytes(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,286 @@
+// Host replay test for the LD2410S component, the ESPHome headers come from test/stubs:
+//   g++ -std=gnu++20 -O2 -Wall -Wno-unknown-pragmas -Itest/stubs -Icomponents -o ld2410s_replay_test
+//     test/ld2410s_replay_test.cpp components/ld2410s/ld2410s.cpp
+//   ./ld2410s_replay_test
+// Boots the component against a simulated radar that acknowledges every command, then replays
+// test/ld2410s-capture.bin through LD2410Srx, LD2410Sschedule and the frame parsers at the UART rate.
+// Prints frames/s, ns/byte and the bytes dropped on resync. Optional arguments: capture file, repetitions.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "ld2410s/ld2410s.h"
+
+namespace esphome {
+Application App;  // NOLINT
+static ESPPreferences preferences;
+ESPPreferences *global_preferences = &preferences;  // NOLINT
+
+static uint32_t now_ms = 0;  // simulated clock, advanced one ms per loop pass
+uint32_t millis() { return now_ms; }
+uint32_t micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace esphome
+
+using esphome::binary_sensor::BinarySensor;
+using esphome::ld2410s::LD2410SComponent;
+using esphome::ld2410s::LD2410Srx;
+using esphome::ld2410s::RX_MAX_BYTES_PER_LOOP;
+using esphome::ld2410s::RxFrameType;
+using esphome::sensor::Sensor;
+using esphome::text_sensor::TextSensor;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      failures++; \
+    } \
+  } while (0)
+
+// what ld2410s_capture.py writes
+static const uint32_t CAPTURE_SHORT_FRAMES = 320;
+static const uint32_t CAPTURE_STD_FRAMES = 80;
+static const uint32_t CAPTURE_CMD_FRAMES = 2;
+static const uint32_t CAPTURE_NOISE_BYTES = 10;
+static const uint32_t CAPTURE_TARGET_RISES = 4;
+
+static const size_t UART_BYTES_PER_MS = 11;  // 115200 baud, 8N1
+static const uint32_t STATS_INTERVAL = 3600000;
+
+static const uint8_t CMD_HEADER[] = {0xFD, 0xFC, 0xFB, 0xFA};
+static const uint8_t CMD_FOOTER[] = {0x04, 0x03, 0x02, 0x01};
+
+static uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static void append_le(std::vector<uint8_t> &out, uint32_t value, size_t size) {
+  for (size_t i = 0; i < size; i++)
+    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+// the radar side of the UART, acknowledges the command frames the component writes
+class SimulatedRadar {
+ public:
+  // answers all complete command frames in the bytes written by the component
+  void receive(const std::vector<uint8_t> &tx) {
+    this->tx_.insert(this->tx_.end(), tx.begin(), tx.end());
+    while (this->tx_.size() >= 10) {
+      if (!std::equal(std::begin(CMD_HEADER), std::end(CMD_HEADER), this->tx_.begin())) {
+        this->tx_.erase(this->tx_.begin());
+        continue;
+      }
+      size_t size = 4 + 2 + (this->tx_[4] | this->tx_[5] << 8) + 4;
+      if (this->tx_.size() < size)
+        return;
+      uint16_t command = this->tx_[6] | this->tx_[7] << 8;
+      this->commands.push_back(command);
+      this->acknowledge_(command);
+      this->tx_.erase(this->tx_.begin(), this->tx_.begin() + size);
+    }
+  }
+  void send(const std::vector<uint8_t> &bytes) { this->rx_.insert(this->rx_.end(), bytes.begin(), bytes.end()); }
+  // moves what the UART carries in one ms to the component
+  void transfer(esphome::uart::UARTDevice &uart) {
+    uint8_t chunk[UART_BYTES_PER_MS];
+    size_t len = std::min(this->rx_.size(), sizeof(chunk));
+    std::copy(this->rx_.begin(), this->rx_.begin() + len, chunk);
+    this->rx_.erase(this->rx_.begin(), this->rx_.begin() + len);
+    uart.inject_rx(chunk, len);
+  }
+  bool idle() const { return this->rx_.empty(); }
+
+  std::vector<uint16_t> commands;
+
+ protected:
+  void acknowledge_(uint16_t command) {
+    std::vector<uint8_t> payload;
+    append_le(payload, command | 0x0100, 2);
+    append_le(payload, 0, 2);  // success
+    switch (command) {
+      case 0x00FF:  // config mode start: protocol version, buffer size
+        append_le(payload, 1, 2);
+        append_le(payload, 64, 2);
+        break;
+      case 0x0000:  // firmware: equipment type, version
+        append_le(payload, 0, 4);
+        append_le(payload, 2, 2);
+        append_le(payload, 4, 2);
+        append_le(payload, 6, 2);
+        break;
+      case 0x0071:  // parameters: max gate, min gate, delay, status freq, distance freq, response speed
+        for (uint32_t value : {12, 0, 10, 40, 50, 5})
+          append_le(payload, value, 4);
+        break;
+      case 0x0073:  // gate 0~7 trigger and hold thresholds
+      case 0x0075:  // gate 8~15 trigger and hold SNRs
+        for (uint32_t gate = 0; gate < 16; gate++)
+          append_le(payload, 30 + gate, 4);
+        break;
+      default:
+        break;
+    }
+    std::vector<uint8_t> frame(std::begin(CMD_HEADER), std::end(CMD_HEADER));
+    append_le(frame, payload.size(), 2);
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    frame.insert(frame.end(), std::begin(CMD_FOOTER), std::end(CMD_FOOTER));
+    this->send(frame);
+  }
+
+  std::vector<uint8_t> tx_;
+  std::deque<uint8_t> rx_;
+};
+
+// one simulated ms: timers, UART transfer, loop pass and command acknowledgements, returns the ns spent in loop()
+static uint64_t step(LD2410SComponent &component, SimulatedRadar &radar) {
+  esphome::now_ms++;
+  component.run_timers();
+  radar.transfer(component);
+  uint64_t start = now_ns();
+  if (component.is_loop_enabled())
+    component.loop();
+  uint64_t elapsed = now_ns() - start;
+  radar.receive(component.take_tx());
+  return elapsed;
+}
+
+static std::vector<uint8_t> read_capture(const char *path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// the receive buffer alone, fed in the blocks the component reads per loop pass
+static void test_rx(const std::vector<uint8_t> &capture, int repetitions) {
+  LD2410Srx rx;
+  uint32_t frames[3] = {};
+  uint64_t start = now_ns();
+  for (int repetition = 0; repetition < repetitions; repetition++) {
+    size_t pos = 0;
+    while (pos < capture.size()) {
+      size_t len = std::min({capture.size() - pos, static_cast<size_t>(RX_MAX_BYTES_PER_LOOP), rx.prepare_write()});
+      std::copy(&capture[pos], &capture[pos + len], rx.write_ptr());
+      rx.commit_write(len);
+      pos += len;
+      while (rx.next_frame(0)) {
+        if (rx.frame_type() == RxFrameType::SHORT_DATA_FRAME) {
+          frames[0]++;
+        } else if (rx.frame_type() == RxFrameType::STD_DATA_FRAME) {
+          frames[1]++;
+        } else {
+          frames[2]++;
+        }
+      }
+    }
+  }
+  uint64_t elapsed = now_ns() - start;
+
+  uint32_t reps = repetitions;
+  CHECK(frames[0] == CAPTURE_SHORT_FRAMES * reps);
+  CHECK(frames[1] == CAPTURE_STD_FRAMES * reps);
+  CHECK(frames[2] == CAPTURE_CMD_FRAMES * reps);
+  CHECK(rx.stats().short_frames == frames[0]);
+  CHECK(rx.stats().std_frames == frames[1]);
+  CHECK(rx.stats().cmd_frames == frames[2]);
+  CHECK(rx.stats().bytes == capture.size() * reps);
+  CHECK(rx.stats().discarded == CAPTURE_NOISE_BYTES * reps);
+  CHECK(rx.stats().overflows == 0);
+
+  uint64_t bytes = rx.stats().bytes;
+  uint64_t total = frames[0] + frames[1] + frames[2];
+  printf("  LD2410Srx:  %.1f ns/byte, %.0f frames/s, %" PRIu32 " bytes dropped on resync\n",
+         static_cast<double>(elapsed) / bytes, total * 1e9 / std::max<uint64_t>(elapsed, 1), rx.stats().discarded);
+}
+
+// boot against the simulated radar, then the capture through the whole component
+static void test_component(const std::vector<uint8_t> &capture, int repetitions) {
+  LD2410SComponent component;
+  SimulatedRadar radar;
+  BinarySensor has_target;
+  Sensor target_distance;
+  Sensor resync_bytes;
+  Sensor command_retries;
+  Sensor command_restarts;
+  Sensor g0_energy;
+  TextSensor fw_version;
+  component.set_has_target_binary_sensor(&has_target);
+  component.set_target_distance_sensor(&target_distance);
+  component.set_resync_bytes_sensor(&resync_bytes);
+  component.set_command_retries_sensor(&command_retries);
+  component.set_command_restarts_sensor(&command_restarts);
+  component.set_gate_energy_sensor(0, &g0_energy);
+  component.set_fw_version_text_sensor(&fw_version);
+  component.set_stats_interval(STATS_INTERVAL);
+  component.set_history_size(100);
+  component.setup();
+
+  // boot: config mode, output mode, firmware, parameters, thresholds, SNRs, config mode end
+  for (int i = 0; i < 2000; i++)
+    step(component, radar);
+  const std::vector<uint16_t> boot = {0x00FF, 0x007A, 0x0000, 0x0071, 0x0073, 0x0075, 0x00FE};
+  CHECK(radar.commands == boot);
+  CHECK(fw_version.state == "v2.4.6");
+
+  // replay at the UART rate, the ACKs in the capture arrive unsolicited and are ignored
+  uint32_t boot_publishes = has_target.publish_count;
+  uint32_t start_ms = esphome::now_ms;
+  uint64_t loop_ns = 0;
+  for (int repetition = 0; repetition < repetitions; repetition++) {
+    radar.send(capture);
+    while (!radar.idle())
+      loop_ns += step(component, radar);
+  }
+  for (int i = 0; i < 10; i++)
+    loop_ns += step(component, radar);
+  uint32_t replay_ms = esphome::now_ms - start_ms;
+  CHECK(radar.commands == boot);
+
+  uint32_t reps = repetitions;
+  CHECK(has_target.publish_count - boot_publishes == 2 * CAPTURE_TARGET_RISES * reps);
+  CHECK(!has_target.state);
+  CHECK(target_distance.state == 0);
+  CHECK(g0_energy.publish_count > 0);
+
+  // the link statistics cover boot and replay
+  esphome::now_ms = STATS_INTERVAL + 1;
+  component.run_timers();
+  CHECK(resync_bytes.state == CAPTURE_NOISE_BYTES * reps);
+  CHECK(command_retries.state == 0);
+  CHECK(command_restarts.state == 0);
+
+  uint64_t bytes = capture.size() * reps;
+  uint64_t frames = (CAPTURE_SHORT_FRAMES + CAPTURE_STD_FRAMES + CAPTURE_CMD_FRAMES) * reps;
+  printf("  component:  %.1f ns/byte, %.0f frames/s, %.0f resync bytes dropped\n",
+         static_cast<double>(loop_ns) / bytes, frames * 1e9 / std::max<uint64_t>(loop_ns, 1), resync_bytes.state);
+  printf("  link:       %.1f frames/s over %" PRIu32 " simulated ms\n", frames * 1000.0 / replay_ms, replay_ms);
+}
+
+int main(int argc, char **argv) {
+  const char *path = argc > 1 ? argv[1] : "test/ld2410s-capture.bin";
+  int repetitions = argc > 2 ? atoi(argv[2]) : 20;
+  std::vector<uint8_t> capture = read_capture(path);
+  if (capture.empty() || repetitions < 1) {
+    printf("ld2410s_replay_test: can not read %s\n", path);
+    return 1;
+  }
+  printf("ld2410s_replay_test: %zu bytes x %d\n", capture.size(), repetitions);
+  test_rx(capture, repetitions);
+  test_component(capture, repetitions);
+  if (failures > 0) {
+    printf("ld2410s_replay_test: %d checks failed\n", failures);
+    return 1;
+  }
+  printf("ld2410s_replay_test: passed\n");
+  return 0;
+}
@@ -0,0 +1,143 @@
+// Host test for the C4001 line assembler, no ESPHome needed:
+//   g++ -std=c++17 -Wall -Icomponents test/line_assembler_test.cpp -o line_assembler_test && ./line_assembler_test
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "dfrobot_c4001/line_assembler.h"
+
+using esphome::dfrobot_c4001::LINE_COMPLETE;
+using esphome::dfrobot_c4001::LINE_DISCARDED;
+using esphome::dfrobot_c4001::LINE_NONE;
+using esphome::dfrobot_c4001::LineAssembler;
+using esphome::dfrobot_c4001::LineEvent;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      failures++; \
+    } \
+  } while (0)
+
+// one event other than LINE_NONE, with the line it reported
+struct Event {
+  LineEvent event;
+  std::string line;
+  bool overflowed;
+};
+
+template<size_t N> static std::vector<Event> feed(LineAssembler<N> &assembler, const std::string &bytes) {
+  std::vector<Event> events;
+  for (char c : bytes) {
+    LineEvent event = assembler.feed(c);
+    if (event == LINE_NONE)
+      continue;
+    std::string line = event == LINE_COMPLETE ? std::string(assembler.line()) : std::string();
+    if (event == LINE_COMPLETE)
+      CHECK(line == assembler.data());
+    events.push_back({event, line, assembler.overflowed()});
+  }
+  return events;
+}
+
+static bool is_line(const Event &event, const char *line) {
+  return event.event == LINE_COMPLETE && event.line == line && !event.overflowed;
+}
+
+// what the module sends for a query, a start and a report, CR LF line ends and a prompt without LF
+static void test_transcript() {
+  LineAssembler<64> assembler;
+  std::vector<Event> events = feed(assembler,
+                                   "getRange\r\n"
+                                   "Response 0.600 6.000\r\n"
+                                   "Done\r\n"
+                                   "DFRobot:/>"
+                                   "sensorStart\r\n"
+                                   "Done\r\n"
+                                   "DFRobot:/>"
+                                   "\r\n"
+                                   "$DFHPD,1, , ,*\r\n");
+  CHECK(events.size() == 9);
+  if (events.size() != 9)
+    return;
+  CHECK(is_line(events[0], "getRange"));
+  CHECK(is_line(events[1], "Response 0.600 6.000"));
+  CHECK(is_line(events[2], "Done"));
+  CHECK(is_line(events[3], "DFRobot:/>"));
+  CHECK(is_line(events[4], "sensorStart"));
+  CHECK(is_line(events[5], "Done"));
+  CHECK(is_line(events[6], "DFRobot:/>"));
+  // the LF after a prompt is an empty line
+  CHECK(is_line(events[7], ""));
+  CHECK(is_line(events[8], "$DFHPD,1, , ,*"));
+  CHECK(assembler.get_discarded_lines() == 0);
+}
+
+static void test_cr_stripped() {
+  LineAssembler<8> assembler;
+  // CR never counts against the capacity, not even inside a line
+  std::vector<Event> events = feed(assembler, "ab\rcd\r\r\n12345678\r\n");
+  CHECK(events.size() == 2);
+  if (events.size() != 2)
+    return;
+  CHECK(is_line(events[0], "abcd"));
+  CHECK(is_line(events[1], "12345678"));
+}
+
+static void test_overflow_discards_until_lf() {
+  LineAssembler<8> assembler;
+  std::vector<Event> events = feed(assembler, "123456789abcdef\r\nDone\r\n");
+  CHECK(events.size() == 2);
+  if (events.size() != 2)
+    return;
+  // the too long line is dropped as a whole, the next one is not spliced with its tail
+  CHECK(events[0].event == LINE_DISCARDED);
+  CHECK(events[0].overflowed);
+  CHECK(is_line(events[1], "Done"));
+  CHECK(assembler.get_discarded_lines() == 1);
+  CHECK(!assembler.discarding());
+}
+
+static void test_full_line_then_prompt() {
+  LineAssembler<8> assembler;
+  // exactly N characters followed by the prompt terminator fit
+  std::vector<Event> events = feed(assembler, "DFRobot:>12345678\n");
+  CHECK(events.size() == 2);
+  if (events.size() != 2)
+    return;
+  CHECK(is_line(events[0], "DFRobot:>"));
+  CHECK(is_line(events[1], "12345678"));
+  CHECK(assembler.get_discarded_lines() == 0);
+}
+
+static void test_overflow_then_prompt() {
+  LineAssembler<8> assembler;
+  // garbage in front of the prompt overflows, the prompt still ends the line and is reported
+  std::vector<Event> events = feed(assembler, "??????????DFRobot:/>Done\r\n");
+  CHECK(events.size() == 2);
+  if (events.size() != 2)
+    return;
+  CHECK(events[0].event == LINE_COMPLETE);
+  CHECK(events[0].line == ">");
+  CHECK(events[0].overflowed);
+  CHECK(is_line(events[1], "Done"));
+  CHECK(assembler.get_discarded_lines() == 1);
+}
+
+int main() {
+  test_transcript();
+  test_cr_stripped();
+  test_overflow_discards_until_lf();
+  test_full_line_then_prompt();
+  test_overflow_then_prompt();
+  if (failures > 0) {
+    printf("line_assembler_test: %d checks failed\n", failures);
+    return 1;
+  }
+  printf("line_assembler_test: passed\n");
+  return 0;
+}
@@ -0,0 +1,120 @@
+// Host test for the C4001 report parser, no ESPHome needed:
+//   g++ -std=c++17 -Wall -Icomponents test/report_parser_test.cpp components/dfrobot_c4001/report_parser.cpp
+//   ./a.out
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include "dfrobot_c4001/report_parser.h"
+
+using esphome::dfrobot_c4001::REPORT_INVALID;
+using esphome::dfrobot_c4001::REPORT_NO_TARGET;
+using esphome::dfrobot_c4001::REPORT_NONE;
+using esphome::dfrobot_c4001::REPORT_PRESENCE;
+using esphome::dfrobot_c4001::REPORT_TARGET;
+using esphome::dfrobot_c4001::ReportParser;
+using esphome::dfrobot_c4001::ReportType;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      failures++; \
+    } \
+  } while (0)
+
+// feeds one line without its LF, the way the hub does while the line is assembled
+static ReportType parse(ReportParser &parser, const std::string &line) {
+  for (char c : line)
+    parser.feed(c);
+  return parser.finish();
+}
+
+static bool near(float value, float expected) { return std::fabs(value - expected) < 1e-4f; }
+
+static void test_presence() {
+  ReportParser parser;
+  CHECK(parse(parser, "$DFHPD,1, , ,*") == REPORT_PRESENCE);
+  CHECK(parser.occupancy());
+  CHECK(parse(parser, "$DFHPD,0, , ,*") == REPORT_PRESENCE);
+  CHECK(!parser.occupancy());
+}
+
+static void test_motion_with_target() {
+  ReportParser parser;
+  CHECK(parse(parser, "$DFDMD,1,0,3.250,0.500,1234,0.000,0.000*") == REPORT_TARGET);
+  CHECK(near(parser.distance(), 3.25f));
+  CHECK(near(parser.speed(), 0.5f));
+  CHECK(near(parser.energy(), 1234.0f));
+}
+
+static void test_motion_without_target() {
+  ReportParser parser;
+  CHECK(parse(parser, "$DFDMD,0,0,0.000,0.000,0,0.000,0.000*") == REPORT_NO_TARGET);
+}
+
+static void test_negative_speed() {
+  ReportParser parser;
+  CHECK(parse(parser, "$DFDMD,1,0,5.125,-0.750,88,0.000,0.000*") == REPORT_TARGET);
+  CHECK(near(parser.distance(), 5.125f));
+  CHECK(near(parser.speed(), -0.75f));
+  // a '-' after the first digit is malformed
+  CHECK(parse(parser, "$DFDMD,1,0,5.125,0-.750,88,0.000,0.000*") == REPORT_INVALID);
+}
+
+static void test_trailing_cr() {
+  ReportParser parser;
+  // the CR in front of the LF reaches the parser, it must not spoil the last field
+  CHECK(parse(parser, "$DFHPD,1\r") == REPORT_PRESENCE);
+  CHECK(parser.occupancy());
+  CHECK(parse(parser, "$DFDMD,1,0,3.250,0.500,1234\r") == REPORT_TARGET);
+  CHECK(near(parser.energy(), 1234.0f));
+  CHECK(parse(parser, "$DFDMD,1,0,3.250,0.500,1234,0.000,0.000*\r") == REPORT_TARGET);
+}
+
+static void test_malformed() {
+  ReportParser parser;
+  CHECK(parse(parser, "$DFHPD,x, , ,*") == REPORT_INVALID);
+  CHECK(parse(parser, "$DFHPD,") == REPORT_INVALID);
+  CHECK(parse(parser, "$DFDMD,1,0,3.2.5,0.500,1234,0.000,0.000*") == REPORT_INVALID);
+  CHECK(parse(parser, "$DFDMD,1,0,3.250,,1234,0.000,0.000*") == REPORT_INVALID);
+  CHECK(parse(parser, "$DFDMD,1,0,3.250") == REPORT_INVALID);
+  // a valid report after a malformed one is not affected by it
+  CHECK(parse(parser, "$DFHPD,1, , ,*") == REPORT_PRESENCE);
+}
+
+static void test_overlong_field() {
+  ReportParser parser;
+  // more than 9 digits would overflow the mantissa
+  CHECK(parse(parser, "$DFDMD,1,0,1234567890,0.500,1234,0.000,0.000*") == REPORT_INVALID);
+  CHECK(parse(parser, "$DFDMD,1,0,123456789,0.500,1234,0.000,0.000*") == REPORT_TARGET);
+  CHECK(near(parser.distance(), 123456789.0f));
+}
+
+static void test_not_a_report() {
+  ReportParser parser;
+  CHECK(parse(parser, "Response 0.600 6.000") == REPORT_NONE);
+  CHECK(parse(parser, "DFRobot:/>") == REPORT_NONE);
+  CHECK(parse(parser, "$DFXYZ,1,2,3*") == REPORT_NONE);
+  CHECK(parse(parser, "") == REPORT_NONE);
+}
+
+int main() {
+  test_presence();
+  test_motion_with_target();
+  test_motion_without_target();
+  test_negative_speed();
+  test_trailing_cr();
+  test_malformed();
+  test_overlong_field();
+  test_not_a_report();
+  if (failures > 0) {
+    printf("report_parser_test: %d checks failed\n", failures);
+    return 1;
+  }
+  printf("report_parser_test: passed\n");
+  return 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome::binary_sensor {
+
+class BinarySensor : public EntityBase {
+ public:
+  void publish_state(bool state) {
+    this->state = state;
+    this->publish_count++;
+  }
+  void publish_initial_state(bool state) { this->publish_state(state); }
+
+  bool state{false};
+  uint32_t publish_count{0};
+};
+
+#define SUB_BINARY_SENSOR(name) \
+ protected: \
+  binary_sensor::BinarySensor *name##_binary_sensor_{nullptr}; \
+\
+ public: \
+  void set_##name##_binary_sensor(binary_sensor::BinarySensor *binary_sensor) { \
+    this->name##_binary_sensor_ = binary_sensor; \
+  }
+#define LOG_BINARY_SENSOR(prefix, type, obj) (void) (obj)
+
+}  // namespace esphome::binary_sensor
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome::button {
+
+class Button : public EntityBase {
+ public:
+  virtual ~Button() = default;
+  void press() { this->press_action(); }
+
+ protected:
+  virtual void press_action() = 0;
+};
+
+#define SUB_BUTTON(name) \
+ protected: \
+  button::Button *name##_button_{nullptr}; \
+\
+ public: \
+  void set_##name##_button(button::Button *button) { this->name##_button_ = button; }
+#define LOG_BUTTON(prefix, type, obj) (void) (obj)
+
+}  // namespace esphome::button
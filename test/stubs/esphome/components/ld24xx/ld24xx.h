@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cmath>
+
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
+
+namespace esphome::ld24xx {
+
+#ifdef USE_SENSOR
+// publishes only values that differ from the last one
+template<typename T> class SensorWithDedup {
+ public:
+  void set_sensor(sensor::Sensor *sens) { this->sens_ = sens; }
+  void publish_state_if_not_dup(T state) {
+    if (this->sens_ == nullptr || (this->published_ && this->last_value_ == state))
+      return;
+    this->last_value_ = state;
+    this->published_ = true;
+    this->sens_->publish_state(static_cast<float>(state));
+  }
+  void publish_state_unknown() {
+    if (this->sens_ == nullptr)
+      return;
+    this->published_ = false;
+    this->sens_->publish_state(NAN);
+  }
+
+  sensor::Sensor *sens_{nullptr};
+
+ protected:
+  T last_value_{};
+  bool published_{false};
+};
+
+#define SUB_SENSOR_WITH_DEDUP(name, dedup_type) \
+ protected: \
+  ld24xx::SensorWithDedup<dedup_type> name##_sensor_{}; \
+\
+ public: \
+  void set_##name##_sensor(sensor::Sensor *sens) { this->name##_sensor_.set_sensor(sens); }
+#define LOG_SENSOR_WITH_DEDUP_SAFE(prefix, type, obj) LOG_SENSOR(prefix, type, (obj).sens_)
+#define SAFE_PUBLISH_SENSOR(obj, value) (obj).publish_state_if_not_dup(value);
+#define SAFE_PUBLISH_SENSOR_UNKNOWN(obj) (obj).publish_state_unknown();
+#endif
+
+}  // namespace esphome::ld24xx
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cmath>
+
+#include "esphome/core/component.h"
+
+namespace esphome::number {
+
+class NumberTraits {
+ public:
+  void set_min_value(float min_value) { this->min_value_ = min_value; }
+  void set_max_value(float max_value) { this->max_value_ = max_value; }
+
+ protected:
+  float min_value_{NAN};
+  float max_value_{NAN};
+};
+
+class Number;
+
+// only set_value() is supported
+class NumberCall {
+ public:
+  explicit NumberCall(Number *parent) : parent_(parent) {}
+  NumberCall &set_value(float value) {
+    this->value_ = value;
+    return *this;
+  }
+  void perform();
+
+ protected:
+  Number *parent_;
+  float value_{NAN};
+};
+
+class Number : public EntityBase {
+ public:
+  virtual ~Number() = default;
+  NumberCall make_call() { return NumberCall(this); }
+  void publish_state(float state) { this->state = state; }
+
+  float state{NAN};
+  NumberTraits traits;
+
+ protected:
+  friend class NumberCall;
+  virtual void control(float value) = 0;
+};
+
+inline void NumberCall::perform() { this->parent_->control(this->value_); }
+
+#define SUB_NUMBER(name) \
+ protected: \
+  number::Number *name##_number_{nullptr}; \
+\
+ public: \
+  void set_##name##_number(number::Number *number) { this->name##_number_ = number; }
+#define LOG_NUMBER(prefix, type, obj) (void) (obj)
+
+}  // namespace esphome::number
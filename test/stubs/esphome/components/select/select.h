@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "esphome/core/component.h"
+
+namespace esphome::select {
+
+class Select;
+
+// only set_index() is supported
+class SelectCall {
+ public:
+  explicit SelectCall(Select *parent) : parent_(parent) {}
+  SelectCall &set_index(size_t index) {
+    this->index_ = index;
+    return *this;
+  }
+  void perform();
+
+ protected:
+  Select *parent_;
+  size_t index_{0};
+};
+
+class Select : public EntityBase {
+ public:
+  virtual ~Select() = default;
+  SelectCall make_call() { return SelectCall(this); }
+  void publish_state(size_t index) { this->index = index; }
+  void publish_state(const std::string &state) { (void) state; }
+
+  size_t index{0};
+
+ protected:
+  friend class SelectCall;
+  virtual void control(size_t index) { (void) index; }
+  virtual void control(const std::string &value) { (void) value; }
+};
+
+inline void SelectCall::perform() { this->parent_->control(this->index_); }
+
+#define SUB_SELECT(name) \
+ protected: \
+  select::Select *name##_select_{nullptr}; \
+\
+ public: \
+  void set_##name##_select(select::Select *select) { this->name##_select_ = select; }
+#define LOG_SELECT(prefix, type, obj) (void) (obj)
+
+}  // namespace esphome::select
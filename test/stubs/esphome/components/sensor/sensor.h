@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cmath>
+
+#include "esphome/core/component.h"
+
+namespace esphome::sensor {
+
+class Sensor : public EntityBase {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    this->publish_count++;
+  }
+  float get_state() const { return this->state; }
+  bool has_state() const { return !std::isnan(this->state); }
+
+  float state{NAN};
+  uint32_t publish_count{0};
+};
+
+#define SUB_SENSOR(name) \
+ protected: \
+  sensor::Sensor *name##_sensor_{nullptr}; \
+\
+ public: \
+  void set_##name##_sensor(sensor::Sensor *sensor) { this->name##_sensor_ = sensor; }
+#define LOG_SENSOR(prefix, type, obj) (void) (obj)
+
+}  // namespace esphome::sensor
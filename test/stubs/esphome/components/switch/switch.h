@@ -0,0 +1,28 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome::switch_ {
+
+class Switch : public EntityBase {
+ public:
+  virtual ~Switch() = default;
+  void turn_on() { this->write_state(true); }
+  void turn_off() { this->write_state(false); }
+  void publish_state(bool state) { this->state = state; }
+
+  bool state{false};
+
+ protected:
+  virtual void write_state(bool state) = 0;
+};
+
+#define SUB_SWITCH(name) \
+ protected: \
+  switch_::Switch *name##_switch_{nullptr}; \
+\
+ public: \
+  void set_##name##_switch(switch_::Switch *s) { this->name##_switch_ = s; }
+#define LOG_SWITCH(prefix, type, obj) (void) (obj)
+
+}  // namespace esphome::switch_
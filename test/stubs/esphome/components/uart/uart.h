@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "esphome/core/component.h"
+
+namespace esphome::uart {
+
+// bytes the host test queued for the component to read, and the bytes the component wrote
+class UARTDevice {
+ public:
+  int available() { return static_cast<int>(this->rx_.size()); }
+  bool read_byte(uint8_t *data) { return this->read_array(data, 1); }
+  bool read_array(uint8_t *data, size_t len) {
+    if (len > this->rx_.size())
+      return false;
+    for (size_t i = 0; i < len; i++) {
+      data[i] = this->rx_.front();
+      this->rx_.pop_front();
+    }
+    return true;
+  }
+  void write_byte(uint8_t data) { this->tx_.push_back(data); }
+  void write_array(const uint8_t *data, size_t len) { this->tx_.insert(this->tx_.end(), data, data + len); }
+  void write_str(const char *str) {
+    while (*str != '\0')
+      this->tx_.push_back(static_cast<uint8_t>(*str++));
+  }
+  void flush() {}
+
+  // host test side
+  void inject_rx(const uint8_t *data, size_t len) { this->rx_.insert(this->rx_.end(), data, data + len); }
+  std::vector<uint8_t> take_tx() {
+    std::vector<uint8_t> tx;
+    tx.swap(this->tx_);
+    return tx;
+  }
+
+ protected:
+  std::deque<uint8_t> rx_;
+  std::vector<uint8_t> tx_;
+};
+
+}  // namespace esphome::uart
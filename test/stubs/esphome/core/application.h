@@ -0,0 +1,14 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+
+class Application {
+ public:
+  uint32_t get_loop_component_start_time() const { return millis(); }
+};
+
+extern Application App;  // NOLINT
+
+}  // namespace esphome
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+namespace setup_priority {
+static const float HARDWARE = 800.0f;
+static const float DATA = 600.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return setup_priority::DATA; }
+
+  void enable_loop() { this->loop_enabled_ = true; }
+  void disable_loop() { this->loop_enabled_ = false; }
+  bool is_loop_enabled() const { return this->loop_enabled_; }
+  void mark_failed(const char *message = nullptr) {
+    (void) message;
+    this->failed_ = true;
+  }
+  bool is_failed() const { return this->failed_; }
+
+  // runs the timeouts and intervals that are due at millis(), the host test calls it once per loop pass
+  void run_timers() {
+    uint32_t now = millis();
+    for (size_t i = 0; i < this->timers_.size(); i++) {
+      if (static_cast<int32_t>(now - this->timers_[i].due) < 0)
+        continue;
+      std::function<void()> callback = this->timers_[i].callback;
+      if (this->timers_[i].interval > 0) {
+        this->timers_[i].due += this->timers_[i].interval;
+      } else {
+        this->timers_.erase(this->timers_.begin() + i--);
+      }
+      callback();
+    }
+  }
+
+ protected:
+  struct Timer {
+    std::string name;
+    uint32_t due;
+    uint32_t interval;  // 0 for a timeout
+    std::function<void()> callback;
+  };
+
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+    this->cancel_timeout(name);
+    this->timers_.push_back({name, millis() + timeout, 0, std::move(f)});
+  }
+  void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+    this->cancel_interval(name);
+    this->timers_.push_back({name, millis() + interval, interval, std::move(f)});
+  }
+  bool cancel_timeout(const std::string &name) { return this->cancel_(name, false); }
+  bool cancel_interval(const std::string &name) { return this->cancel_(name, true); }
+  bool cancel_(const std::string &name, bool interval) {
+    for (auto it = this->timers_.begin(); it != this->timers_.end(); ++it) {
+      if (it->name == name && (it->interval > 0) == interval) {
+        this->timers_.erase(it);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::vector<Timer> timers_;
+  bool loop_enabled_{true};
+  bool failed_{false};
+};
+
+class EntityBase {
+ public:
+  const char *get_name() const { return ""; }
+  // preference keys only have to differ between entities
+  uint32_t get_object_id_hash() const { return fnv1a_hash(std::to_string(reinterpret_cast<uintptr_t>(this))); }
+};
+
+}  // namespace esphome
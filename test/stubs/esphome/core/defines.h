@@ -0,0 +1,10 @@
+#pragma once
+// Minimal stand-ins for the ESPHome headers the components include, enough to build them into host tests.
+
+#define USE_BINARY_SENSOR
+#define USE_BUTTON
+#define USE_NUMBER
+#define USE_SELECT
+#define USE_SENSOR
+#define USE_SWITCH
+#define USE_TEXT_SENSOR
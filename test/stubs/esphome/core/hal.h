@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+// provided by the host test, usually a simulated clock
+uint32_t millis();
+uint32_t micros();
+
+}  // namespace esphome
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+
+#include "esphome/core/hal.h"
+
+namespace esphome {
+
+template<typename T> using optional = std::optional<T>;
+
+constexpr uint16_t encode_uint16(uint8_t msb, uint8_t lsb) { return (static_cast<uint16_t>(msb) << 8) | lsb; }
+
+constexpr size_t format_hex_pretty_size(size_t byte_count) { return byte_count * 3 + 1; }
+inline char *format_hex_pretty_to(char *buffer, const uint8_t *data, size_t length, char separator) {
+  static const char *const DIGITS = "0123456789ABCDEF";
+  size_t pos = 0;
+  for (size_t i = 0; i < length; i++) {
+    if (i > 0)
+      buffer[pos++] = separator;
+    buffer[pos++] = DIGITS[data[i] >> 4];
+    buffer[pos++] = DIGITS[data[i] & 0x0F];
+  }
+  buffer[pos] = '\0';
+  return buffer;
+}
+
+inline uint32_t fnv1a_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+inline bool str_startswith(const std::string &str, const std::string &start) { return str.rfind(start, 0) == 0; }
+
+// the whole string has to be a number that fits T, like the ESPHome helper
+template<typename T, std::enable_if_t<std::is_integral_v<T> && std::is_unsigned_v<T>, int> = 0>
+optional<T> parse_number(const char *str) {
+  char *end = nullptr;
+  unsigned long value = ::strtoul(str, &end, 10);  // NOLINT(google-runtime-int)
+  if (end == str || *end != '\0' || value > std::numeric_limits<T>::max())
+    return {};
+  return value;
+}
+template<typename T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0> optional<T> parse_number(const char *str) {
+  char *end = nullptr;
+  float value = ::strtof(str, &end);
+  if (end == str || *end != '\0' || value == HUGE_VALF)
+    return {};
+  return value;
+}
+
+template<typename T> class Parented {
+ public:
+  Parented() = default;
+  explicit Parented(T *parent) : parent_(parent) {}
+  T *get_parent() const { return this->parent_; }
+  void set_parent(T *parent) { this->parent_ = parent; }
+
+ protected:
+  T *parent_{nullptr};
+};
+
+#define TRUEFALSE(b) ((b) ? "TRUE" : "FALSE")
+#define YESNO(b) ((b) ? "YES" : "NO")
+#define ONOFF(b) ((b) ? "ON" : "OFF")
+
+}  // namespace esphome
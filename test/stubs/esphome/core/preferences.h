@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+// keeps the stored objects in RAM, a second component instance can restore what the first one saved
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  explicit ESPPreferenceObject(std::vector<uint8_t> *storage) : storage_(storage) {}
+
+  template<typename T> bool save(const T *src) {
+    if (this->storage_ == nullptr)
+      return false;
+    this->storage_->assign(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<const uint8_t *>(src) + sizeof(T));
+    return true;
+  }
+  template<typename T> bool load(T *dest) {
+    if (this->storage_ == nullptr || this->storage_->size() != sizeof(T))
+      return false;
+    std::memcpy(dest, this->storage_->data(), sizeof(T));
+    return true;
+  }
+
+ protected:
+  std::vector<uint8_t> *storage_{nullptr};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash = false) {
+    (void) in_flash;
+    return ESPPreferenceObject(&this->storage_[type]);
+  }
+
+ protected:
+  std::map<uint32_t, std::vector<uint8_t>> storage_;
+};
+
+extern ESPPreferences *global_preferences;  // NOLINT
+
+}  // namespace esphome